@@ -0,0 +1,67 @@
+# Общие настройки бенчмарков: слой данных планировщика без интерфейса
+# и генератор синтетических задач
+
+QT       += core concurrent testlib
+QT       -= gui
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SCHEDULER_ROOT = $$PWD/..
+INCLUDEPATH += $$SCHEDULER_ROOT $$PWD/common
+
+SOURCES += \
+        $$SCHEDULER_ROOT/models/task.cpp \
+        $$SCHEDULER_ROOT/models/user.cpp \
+        $$SCHEDULER_ROOT/models/project.cpp \
+        $$SCHEDULER_ROOT/models/taskchangedispatcher.cpp \
+        $$SCHEDULER_ROOT/data/taskrepository.cpp \
+        $$SCHEDULER_ROOT/data/userrepository.cpp \
+        $$SCHEDULER_ROOT/data/projectrepository.cpp \
+        $$SCHEDULER_ROOT/data/taskservice.cpp \
+        $$SCHEDULER_ROOT/data/strategies.cpp \
+        $$SCHEDULER_ROOT/data/trigramindex.cpp \
+        $$SCHEDULER_ROOT/data/slotbitmap.cpp \
+        $$SCHEDULER_ROOT/data/queryplanner.cpp \
+        $$SCHEDULER_ROOT/data/tasksortkey.cpp \
+        $$SCHEDULER_ROOT/data/taskview.cpp \
+        $$SCHEDULER_ROOT/data/jsonarrayreader.cpp \
+        $$SCHEDULER_ROOT/data/querycompiler.cpp \
+        $$SCHEDULER_ROOT/data/casefoldsearch.cpp \
+        $$SCHEDULER_ROOT/data/fulltextindex.cpp \
+        $$SCHEDULER_ROOT/data/fuzzyindex.cpp \
+        $$SCHEDULER_ROOT/data/completionindex.cpp \
+        $$SCHEDULER_ROOT/data/duplicateindex.cpp \
+        $$PWD/common/benchdata.cpp
+
+HEADERS += \
+        $$SCHEDULER_ROOT/models/task.h \
+        $$SCHEDULER_ROOT/models/user.h \
+        $$SCHEDULER_ROOT/models/project.h \
+        $$SCHEDULER_ROOT/models/taskchangedispatcher.h \
+        $$SCHEDULER_ROOT/data/repositories.h \
+        $$SCHEDULER_ROOT/data/slotstore.h \
+        $$SCHEDULER_ROOT/data/nameindex.h \
+        $$SCHEDULER_ROOT/data/generationcache.h \
+        $$SCHEDULER_ROOT/data/strategies.h \
+        $$SCHEDULER_ROOT/data/filtercombinators.h \
+        $$SCHEDULER_ROOT/data/taskrepository.h \
+        $$SCHEDULER_ROOT/data/userrepository.h \
+        $$SCHEDULER_ROOT/data/projectrepository.h \
+        $$SCHEDULER_ROOT/data/taskservice.h \
+        $$SCHEDULER_ROOT/data/trigramindex.h \
+        $$SCHEDULER_ROOT/data/slotbitmap.h \
+        $$SCHEDULER_ROOT/data/queryplanner.h \
+        $$SCHEDULER_ROOT/data/tasksortkey.h \
+        $$SCHEDULER_ROOT/data/taskview.h \
+        $$SCHEDULER_ROOT/data/taskstream.h \
+        $$SCHEDULER_ROOT/data/jsonarrayreader.h \
+        $$SCHEDULER_ROOT/data/querycompiler.h \
+        $$SCHEDULER_ROOT/data/casefoldsearch.h \
+        $$SCHEDULER_ROOT/data/fulltextindex.h \
+        $$SCHEDULER_ROOT/data/fuzzyindex.h \
+        $$SCHEDULER_ROOT/data/completionindex.h \
+        $$SCHEDULER_ROOT/data/duplicateindex.h \
+        $$PWD/common/benchdata.h
@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# Бенчмарки планировщика (QTest, QBENCHMARK)
+# Сборка: qmake && make; запуск всех: make check
+# Число задач в наборе задается переменной окружения SCHEDULER_BENCH_TASKS
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+        filterbench \
+        sortbench \
+        typingbench \
+        fulltextbench \
+        fuzzybench \
+        taskmemory
@@ -0,0 +1,108 @@
+#include "benchdata.h"
+#include "data/taskservice.h"
+#include "models/task.h"
+#include "models/user.h"
+#include "models/project.h"
+#include <QDateTime>
+#include <QStringList>
+#include <QtAlgorithms>
+
+namespace {
+
+const char *const VERBS[] = {
+    "Подготовить", "Проверить", "Согласовать", "Обновить", "Исправить",
+    "Написать", "Отправить", "Провести", "Разобрать", "Оформить"
+};
+const char *const NOUNS[] = {
+    "отчет", "договор", "презентацию", "сборку", "документацию",
+    "релиз", "встречу", "бюджет", "план", "тесты", "макет", "счет"
+};
+const char *const DETAILS[] = {
+    "за месяц", "для клиента", "по проекту", "к пятнице", "для отдела",
+    "после ревью", "на сервере", "по итогам", "в репозитории", "до конца недели"
+};
+
+template<typename T, int N>
+int countOf(T (&)[N])
+{
+    return N;
+}
+
+// xorshift32: одинаковая последовательность на всех платформах
+quint32 nextRandom(quint32 &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+QString pick(const char *const *words, int count, quint32 &state)
+{
+    return QString::fromUtf8(words[nextRandom(state) % count]);
+}
+
+}
+
+namespace BenchData {
+
+int taskCount(int defaultCount)
+{
+    bool ok = false;
+    int count = qEnvironmentVariableIntValue("SCHEDULER_BENCH_TASKS", &ok);
+    return ok && count > 0 ? count : defaultCount;
+}
+
+QString title(int index)
+{
+    quint32 state = 2463534242u + quint32(index) * 2654435761u;
+    nextRandom(state);
+    return pick(VERBS, countOf(VERBS), state) + ' ' +
+           pick(NOUNS, countOf(NOUNS), state) + ' ' +
+           pick(DETAILS, countOf(DETAILS), state) + ' ' +
+           QString::number(index % 1000);
+}
+
+void fill(TaskService *service, int count, int users, int projects)
+{
+    QList<User*> userList;
+    for (int i = 0; i < users; ++i) {
+        User *user = new User(QString("Пользователь %1").arg(i));
+        service->addUser(user);
+        userList.append(user);
+    }
+    QList<Project*> projectList;
+    for (int i = 0; i < projects; ++i) {
+        Project *project = new Project(QString("Проект %1").arg(i));
+        service->addProject(project);
+        projectList.append(project);
+    }
+    
+    const QDateTime base(QDate(2026, 1, 1), QTime(9, 0));
+    quint32 state = 88172645u;
+    for (int i = 0; i < count; ++i) {
+        quint32 r = nextRandom(state);
+        Priority priority = static_cast<Priority>(r % 3);
+        QDateTime deadline = r % 10 == 0 ? QDateTime() : base.addSecs(qint64(nextRandom(state) % (365 * 24)) * 3600);
+        Task *task = new Task(title(i), deadline, priority,
+                              userList.isEmpty() ? nullptr : userList.at(nextRandom(state) % userList.size()),
+                              projectList.isEmpty() ? nullptr : projectList.at(nextRandom(state) % projectList.size()));
+        task->setDescription(pick(VERBS, countOf(VERBS), state) + ' ' + pick(NOUNS, countOf(NOUNS), state) + ' ' +
+                             pick(DETAILS, countOf(DETAILS), state) + ' ' + pick(NOUNS, countOf(NOUNS), state));
+        task->setCompleted(nextRandom(state) % 5 == 0);
+        service->addTask(task);
+    }
+}
+
+void clear(TaskService *service)
+{
+    QList<Task*> tasks = service->getAllTasks();
+    QList<User*> users = service->getAllUsers();
+    QList<Project*> projects = service->getAllProjects();
+    service->clearAll();
+    qDeleteAll(tasks);
+    qDeleteAll(users);
+    qDeleteAll(projects);
+}
+
+}
@@ -0,0 +1,27 @@
+#ifndef BENCHDATA_H
+#define BENCHDATA_H
+
+#include <QString>
+
+class TaskService;
+
+// Синтетические данные для бенчмарков: пользователи, проекты и задачи
+// с названиями и описаниями из русских слов. Генератор детерминирован,
+// поэтому прогоны на разных машинах и сборках работают с одним набором
+namespace BenchData {
+
+// Число задач: SCHEDULER_BENCH_TASKS из окружения или defaultCount
+int taskCount(int defaultCount);
+
+// Добавляет в сервис users пользователей, projects проектов и count задач
+void fill(TaskService *service, int count, int users = 50, int projects = 20);
+
+// Удаляет задачи, пользователей и проекты сервиса: репозитории ими не владеют
+void clear(TaskService *service);
+
+// Название задачи с номером index - то же, что получает задача в fill
+QString title(int index);
+
+}
+
+#endif // BENCHDATA_H
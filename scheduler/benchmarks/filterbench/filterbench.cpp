@@ -0,0 +1,100 @@
+#include <QtTest>
+#include "benchdata.h"
+#include "data/taskrepository.h"
+#include "data/userrepository.h"
+#include "data/projectrepository.h"
+#include "data/taskservice.h"
+#include "data/filtercombinators.h"
+#include "models/user.h"
+
+// Фильтр "высокий приоритет, владелец, не завершена, в названии 'отчет'":
+// цепочка стратегий (проход и новый список на каждую) против одного
+// составного предиката TaskFilter и того же предиката через адаптер стратегии
+class FilterBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void sameResult();
+    void strategyChain();
+    void fusedPredicate();
+    void fusedStrategy();
+
+private:
+    typedef TaskFilter::And<TaskFilter::PriorityIs, TaskFilter::OwnerIs,
+                            TaskFilter::Not<TaskFilter::CompletedIs>,
+                            TaskFilter::TitleContains> Fused;
+    Fused fused() const;
+
+    TaskService *m_service = nullptr;
+    User *m_owner = nullptr;
+    QList<IFilterStrategy*> m_chain;
+};
+
+void FilterBenchmark::initTestCase()
+{
+    m_service = new TaskService(new TaskRepository(this), new UserRepository(this),
+                                new ProjectRepository(this), this);
+    BenchData::fill(m_service, BenchData::taskCount(1000000), 10);
+    m_owner = m_service->getAllUsers().first();
+    m_chain << new PriorityFilterStrategy(Priority::High)
+            << new UserFilterStrategy(m_owner)
+            << new CompletedFilterStrategy(false)
+            << new TitleSearchFilterStrategy(QString("отчет").toCaseFolded());
+}
+
+void FilterBenchmark::cleanupTestCase()
+{
+    qDeleteAll(m_chain);
+    BenchData::clear(m_service);
+}
+
+FilterBenchmark::Fused FilterBenchmark::fused() const
+{
+    TaskFilter::PriorityIs priority = { Priority::High };
+    TaskFilter::OwnerIs owner = { m_owner };
+    TaskFilter::CompletedIs completed = { true };
+    TaskFilter::TitleContains title = { QString("отчет").toCaseFolded() };
+    return TaskFilter::all(priority, owner, TaskFilter::negate(completed), title);
+}
+
+void FilterBenchmark::sameResult()
+{
+    QList<Task*> chain = m_service->filterTasks(m_chain);
+    QVERIFY(!chain.isEmpty());
+    QCOMPARE(m_service->filterTasks(fused()), chain);
+}
+
+void FilterBenchmark::strategyChain()
+{
+    QList<Task*> result;
+    QBENCHMARK {
+        result = m_service->filterTasks(m_chain);
+    }
+}
+
+void FilterBenchmark::fusedPredicate()
+{
+    Fused predicate = fused();
+    QList<Task*> result;
+    QBENCHMARK {
+        result = m_service->filterTasks(predicate);
+    }
+}
+
+void FilterBenchmark::fusedStrategy()
+{
+    QScopedPointer<IFilterStrategy> strategy(TaskFilter::makeStrategy(fused()));
+    QList<IFilterStrategy*> filters;
+    filters << strategy.data();
+    QList<Task*> result;
+    QBENCHMARK {
+        result = m_service->filterTasks(filters);
+    }
+}
+
+QTEST_GUILESS_MAIN(FilterBenchmark)
+
+#include "filterbench.moc"
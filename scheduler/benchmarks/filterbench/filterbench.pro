@@ -0,0 +1,9 @@
+# Составной предикат TaskFilter против цепочки стратегий IFilterStrategy
+
+include(../benchmarks.pri)
+
+TARGET = filterbench
+TEMPLATE = app
+
+SOURCES += \
+        filterbench.cpp
@@ -0,0 +1,59 @@
+#include <QtTest>
+#include "benchdata.h"
+#include "data/taskrepository.h"
+#include "data/userrepository.h"
+#include "data/projectrepository.h"
+#include "data/taskservice.h"
+
+// searchFullText на 1M задач: первые 20 результатов по частым и редким словам
+// и по фразе. Цель - меньше 10 мс на запрос
+class FullTextBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void search_data();
+    void search();
+
+private:
+    TaskService *m_service = nullptr;
+};
+
+void FullTextBenchmark::initTestCase()
+{
+    m_service = new TaskService(new TaskRepository(this), new UserRepository(this),
+                                new ProjectRepository(this), this);
+    BenchData::fill(m_service, BenchData::taskCount(1000000));
+}
+
+void FullTextBenchmark::cleanupTestCase()
+{
+    BenchData::clear(m_service);
+}
+
+void FullTextBenchmark::search_data()
+{
+    QTest::addColumn<QString>("query");
+    QTest::newRow("frequent word") << QString("отчет");
+    QTest::newRow("two words") << QString("отчет клиента");
+    QTest::newRow("three words") << QString("согласовать бюджет месяц");
+    QTest::newRow("phrase") << QString("\"подготовить отчет\"");
+    QTest::newRow("missing word") << QString("отпуск");
+}
+
+void FullTextBenchmark::search()
+{
+    QFETCH(QString, query);
+
+    QList<Task*> result;
+    QBENCHMARK {
+        result = m_service->searchFullText(query, 20);
+    }
+    QVERIFY(result.size() <= 20);
+}
+
+QTEST_GUILESS_MAIN(FullTextBenchmark)
+
+#include "fulltextbench.moc"
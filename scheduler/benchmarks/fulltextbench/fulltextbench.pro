@@ -0,0 +1,9 @@
+# Полнотекстовый поиск BM25 по названиям и описаниям
+
+include(../benchmarks.pri)
+
+TARGET = fulltextbench
+TEMPLATE = app
+
+SOURCES += \
+        fulltextbench.cpp
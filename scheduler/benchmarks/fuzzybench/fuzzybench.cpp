@@ -0,0 +1,60 @@
+#include <QtTest>
+#include "benchdata.h"
+#include "data/taskrepository.h"
+#include "data/userrepository.h"
+#include "data/projectrepository.h"
+#include "data/taskservice.h"
+
+// searchByTitle(keyword, true) на 200 тыс. названий: запросы с одной и двумя
+// опечатками и без них. Задержка должна оставаться интерактивной
+class FuzzyBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void search_data();
+    void search();
+
+private:
+    TaskService *m_service = nullptr;
+};
+
+void FuzzyBenchmark::initTestCase()
+{
+    m_service = new TaskService(new TaskRepository(this), new UserRepository(this),
+                                new ProjectRepository(this), this);
+    BenchData::fill(m_service, BenchData::taskCount(200000));
+}
+
+void FuzzyBenchmark::cleanupTestCase()
+{
+    BenchData::clear(m_service);
+}
+
+void FuzzyBenchmark::search_data()
+{
+    QTest::addColumn<QString>("keyword");
+    QTest::newRow("exact word") << QString("отчет");
+    QTest::newRow("one typo") << QString("отчот");
+    QTest::newRow("two typos in one word") << QString("пдготавить");
+    QTest::newRow("typo in each word") << QString("пдготовить отчот");
+    QTest::newRow("typos in two words") << QString("сагласовать бюжет");
+    QTest::newRow("prefix while typing") << QString("подготовить док");
+}
+
+void FuzzyBenchmark::search()
+{
+    QFETCH(QString, keyword);
+
+    QList<Task*> result;
+    QBENCHMARK {
+        result = m_service->searchByTitle(keyword, true);
+    }
+    QVERIFY(!result.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(FuzzyBenchmark)
+
+#include "fuzzybench.moc"
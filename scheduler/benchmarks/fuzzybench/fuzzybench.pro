@@ -0,0 +1,9 @@
+# Нечеткий поиск по названиям с опечатками
+
+include(../benchmarks.pri)
+
+TARGET = fuzzybench
+TEMPLATE = app
+
+SOURCES += \
+        fuzzybench.cpp
@@ -0,0 +1,109 @@
+#include <QtTest>
+#include "benchdata.h"
+#include "data/taskrepository.h"
+#include "data/userrepository.h"
+#include "data/projectrepository.h"
+#include "data/taskservice.h"
+#include "models/task.h"
+
+Q_DECLARE_METATYPE(TaskService::FilterOptions)
+Q_DECLARE_METATYPE(TaskService::SortOptions)
+
+// getFilteredAndSortedTasks на большом наборе: порог 0 - все последовательно,
+// порог 1 - фильтрация остаточных условий и сортировка в пуле потоков.
+// Перед каждым прогоном одна задача меняется, чтобы кеш запросов и уточнение
+// предыдущего поиска не подменяли замер
+class SortBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void sameResult_data() { filterAndSort_data(); }
+    void sameResult();
+    void filterAndSort_data();
+    void filterAndSort();
+
+private:
+    void touch();
+
+    TaskService *m_service = nullptr;
+    Task *m_touched = nullptr;
+};
+
+void SortBenchmark::initTestCase()
+{
+    m_service = new TaskService(new TaskRepository(this), new UserRepository(this),
+                                new ProjectRepository(this), this);
+    BenchData::fill(m_service, BenchData::taskCount(1000000));
+    m_touched = m_service->getAllTasks().first();
+    qDebug("%d tasks, %d threads", m_service->getAllTasks().size(), QThread::idealThreadCount());
+}
+
+void SortBenchmark::cleanupTestCase()
+{
+    BenchData::clear(m_service);
+}
+
+// Изменение упреждения напоминания переиндексирует только атрибуты одной задачи
+void SortBenchmark::touch()
+{
+    m_touched->setReminderMinutes(m_touched->getReminderMinutes() == 60 ? 61 : 60);
+}
+
+void SortBenchmark::filterAndSort_data()
+{
+    QTest::addColumn<TaskService::FilterOptions>("filter");
+    QTest::addColumn<TaskService::SortOptions>("sort");
+    QTest::addColumn<int>("threshold");
+
+    TaskService::FilterOptions all;
+    TaskService::SortOptions byTitle;
+    byTitle.criteria = TaskService::SortOptions::SortByTitle;
+
+    TaskService::FilterOptions active;
+    active.showCompleted = false;
+    active.searchText = QString("от");
+    TaskService::SortOptions byPriorityThenDate;
+    SortKey priority = { SortKey::ByPriority, false };
+    SortKey date = { SortKey::ByDate, true };
+    byPriorityThenDate.keys << priority << date;
+
+    QTest::newRow("all by title, sequential") << all << byTitle << 0;
+    QTest::newRow("all by title, parallel") << all << byTitle << 1;
+    QTest::newRow("active 'от' by priority, date, sequential") << active << byPriorityThenDate << 0;
+    QTest::newRow("active 'от' by priority, date, parallel") << active << byPriorityThenDate << 1;
+}
+
+// Параллельный путь обязан давать тот же порядок, что и последовательный
+void SortBenchmark::sameResult()
+{
+    QFETCH(TaskService::FilterOptions, filter);
+    QFETCH(TaskService::SortOptions, sort);
+
+    m_service->setParallelThreshold(0);
+    touch();
+    QList<Task*> sequential = m_service->getFilteredAndSortedTasks(filter, sort);
+    m_service->setParallelThreshold(1);
+    touch();
+    QCOMPARE(m_service->getFilteredAndSortedTasks(filter, sort), sequential);
+}
+
+void SortBenchmark::filterAndSort()
+{
+    QFETCH(TaskService::FilterOptions, filter);
+    QFETCH(TaskService::SortOptions, sort);
+    QFETCH(int, threshold);
+
+    m_service->setParallelThreshold(threshold);
+    QList<Task*> result;
+    QBENCHMARK {
+        touch();
+        result = m_service->getFilteredAndSortedTasks(filter, sort);
+    }
+}
+
+QTEST_GUILESS_MAIN(SortBenchmark)
+
+#include "sortbench.moc"
@@ -0,0 +1,9 @@
+# Фильтрация и сортировка getFilteredAndSortedTasks: последовательно и в пуле потоков
+
+include(../benchmarks.pri)
+
+TARGET = sortbench
+TEMPLATE = app
+
+SOURCES += \
+        sortbench.cpp
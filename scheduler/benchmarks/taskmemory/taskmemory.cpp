@@ -0,0 +1,157 @@
+#include <QtTest>
+#include <QVector>
+#include <cstdlib>
+#include "benchdata.h"
+#include "data/taskrepository.h"
+#include "data/userrepository.h"
+#include "data/projectrepository.h"
+#include "data/taskservice.h"
+#include "models/task.h"
+#include "models/user.h"
+#include "models/project.h"
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define TASKMEMORY_HAS_MALLINFO2
+#endif
+
+// Байты кучи на задачу: каждая часть выделяется для всех задач набора подряд,
+// разница занятой кучи (mallinfo2 glibc) до и после делится на число задач.
+// Результат - метрика BytesAllocated; без glibc 2.33+ замер пропускается
+class TaskMemory : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void titleString();
+    void foldedTitleCache();
+    void sortKeyCache();
+    void taskRecord();
+    void repository();
+
+private:
+    static qint64 heapInUse();
+    void report(const char *what, qint64 before, qint64 after);
+
+    int m_count = 0;
+    QVector<QString> m_titles;
+    qreal m_titleBytes = 0;
+    qreal m_cacheBytes = 0;
+};
+
+qint64 TaskMemory::heapInUse()
+{
+#ifdef TASKMEMORY_HAS_MALLINFO2
+    struct mallinfo2 info = mallinfo2();
+    return qint64(info.uordblks + info.hblkhd);
+#else
+    return -1;
+#endif
+}
+
+void TaskMemory::report(const char *what, qint64 before, qint64 after)
+{
+    qreal perTask = qreal(after - before) / m_count;
+    qInfo("%s: %.1f bytes per task", what, perTask);
+    QTest::setBenchmarkResult(perTask, QTest::BytesAllocated);
+}
+
+void TaskMemory::initTestCase()
+{
+    if (heapInUse() < 0) {
+        QSKIP("Замер памяти требует glibc 2.33+ (mallinfo2)");
+    }
+    m_count = BenchData::taskCount(200000);
+    m_titles.reserve(m_count);
+    for (int i = 0; i < m_count; ++i) {
+        m_titles.append(BenchData::title(i));
+    }
+}
+
+// Само название: строка с данными UTF-16
+void TaskMemory::titleString()
+{
+    QVector<QString> titles(m_count);
+    qint64 before = heapInUse();
+    for (int i = 0; i < m_count; ++i) {
+        titles[i] = BenchData::title(i);
+    }
+    qint64 after = heapInUse();
+    m_titleBytes = qreal(after - before) / m_count;
+    report("title", before, after);
+}
+
+// Кеш m_foldedTitle
+void TaskMemory::foldedTitleCache()
+{
+    QVector<QString> folded(m_count);
+    qint64 before = heapInUse();
+    for (int i = 0; i < m_count; ++i) {
+        folded[i] = m_titles.at(i).toCaseFolded();
+    }
+    qint64 after = heapInUse();
+    m_cacheBytes += qreal(after - before) / m_count;
+    report("folded title cache", before, after);
+}
+
+// Кеш m_titleSortKey: ключ сопоставления коллатора локали
+void TaskMemory::sortKeyCache()
+{
+    QVector<QCollatorSortKey> keys;
+    keys.reserve(m_count);
+    Task::collationKey(m_titles.first()); // коллатор создается при первом вызове
+    qint64 before = heapInUse();
+    for (int i = 0; i < m_count; ++i) {
+        keys.append(Task::collationKey(m_titles.at(i)));
+    }
+    qint64 after = heapInUse();
+    m_cacheBytes += qreal(after - before) / m_count;
+    report("title sort key cache", before, after);
+}
+
+// Задача вне репозитория: запись, название и оба кеша, без описания
+void TaskMemory::taskRecord()
+{
+    QVector<Task*> tasks(m_count);
+    qint64 before = heapInUse();
+    for (int i = 0; i < m_count; ++i) {
+        tasks[i] = new Task(BenchData::title(i), QDateTime(), Priority::Medium, nullptr);
+    }
+    qint64 after = heapInUse();
+    report("task with title and caches", before, after);
+    qInfo("  of which record %.1f, title %.1f, caches %.1f bytes",
+          qreal(after - before) / m_count - m_titleBytes - m_cacheBytes, m_titleBytes, m_cacheBytes);
+    qDeleteAll(tasks);
+}
+
+// Полный набор BenchData::fill: задачи с описаниями плюс индексы репозитория.
+// Репозитории задачами не владеют, поэтому после их удаления в куче остаются
+// только задачи - разница и есть доля индексов
+void TaskMemory::repository()
+{
+    QObject owner;
+    qint64 before = heapInUse();
+    TaskService *service = new TaskService(new TaskRepository(&owner), new UserRepository(&owner),
+                                           new ProjectRepository(&owner), &owner);
+    BenchData::fill(service, m_count);
+    qint64 filled = heapInUse();
+    report("tasks with descriptions and repository indexes", before, filled);
+
+    QList<Task*> tasks = service->getAllTasks();
+    QList<User*> users = service->getAllUsers();
+    QList<Project*> projects = service->getAllProjects();
+    qint64 withLists = heapInUse();
+    delete service;
+    qDeleteAll(owner.children());
+    qint64 unindexed = heapInUse();
+    qInfo("  of which repository and indexes %.1f bytes", qreal(withLists - unindexed) / m_count);
+
+    qDeleteAll(tasks);
+    qDeleteAll(users);
+    qDeleteAll(projects);
+}
+
+QTEST_GUILESS_MAIN(TaskMemory)
+
+#include "taskmemory.moc"
@@ -0,0 +1,9 @@
+# Память на задачу: запись Task, кеши названия и индексы репозитория
+
+include(../benchmarks.pri)
+
+TARGET = taskmemory
+TEMPLATE = app
+
+SOURCES += \
+        taskmemory.cpp
@@ -0,0 +1,120 @@
+#include <QtTest>
+#include "benchdata.h"
+#include "data/taskrepository.h"
+#include "data/userrepository.h"
+#include "data/projectrepository.h"
+#include "data/taskservice.h"
+#include "models/task.h"
+
+// Строка поиска набирается по символу, как в TaskListWidget: на каждое нажатие
+// queryError и getFilteredAndSortedTasks. typing - стоимость набора первых
+// length символов подряд (разность соседних строк - цена одного нажатия),
+// fromScratch - тот же префикс без предыдущего поиска
+class TypingBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void sameResult_data() { typing_data(); }
+    void sameResult();
+    void typing_data();
+    void typing();
+    void fromScratch_data() { typing_data(); }
+    void fromScratch();
+
+private:
+    void touch();
+    QList<Task*> search(const QString &text) const;
+
+    TaskService *m_service = nullptr;
+    Task *m_touched = nullptr;
+    TaskService::SortOptions m_sort;
+};
+
+static const char TYPED_TEXT[] = "подготовить отчет за месяц";
+
+void TypingBenchmark::initTestCase()
+{
+    m_service = new TaskService(new TaskRepository(this), new UserRepository(this),
+                                new ProjectRepository(this), this);
+    BenchData::fill(m_service, BenchData::taskCount(1000000));
+    m_touched = m_service->getAllTasks().first();
+}
+
+void TypingBenchmark::cleanupTestCase()
+{
+    BenchData::clear(m_service);
+}
+
+// Новое поколение данных: сбрасывает кеш запросов и запомненный поиск
+void TypingBenchmark::touch()
+{
+    m_touched->setReminderMinutes(m_touched->getReminderMinutes() == 60 ? 61 : 60);
+}
+
+QList<Task*> TypingBenchmark::search(const QString &text) const
+{
+    TaskService::FilterOptions filter;
+    if (m_service->queryError(text).isEmpty()) {
+        filter.query = text;
+    } else {
+        filter.searchText = text;
+    }
+    return m_service->getFilteredAndSortedTasks(filter, m_sort);
+}
+
+void TypingBenchmark::typing_data()
+{
+    QTest::addColumn<int>("length");
+    const int total = QString::fromUtf8(TYPED_TEXT).size();
+    for (int length = 1; length <= total; ++length) {
+        QTest::newRow(qPrintable(QString::number(length))) << length;
+    }
+}
+
+// Уточнение предыдущего результата не меняет ответ
+void TypingBenchmark::sameResult()
+{
+    QFETCH(int, length);
+    const QString text = QString::fromUtf8(TYPED_TEXT);
+
+    touch();
+    QList<Task*> typed;
+    for (int i = 1; i <= length; ++i) {
+        typed = search(text.left(i));
+    }
+    touch();
+    QCOMPARE(search(text.left(length)), typed);
+}
+
+void TypingBenchmark::typing()
+{
+    QFETCH(int, length);
+    const QString text = QString::fromUtf8(TYPED_TEXT);
+
+    QList<Task*> result;
+    QBENCHMARK {
+        touch();
+        for (int i = 1; i <= length; ++i) {
+            result = search(text.left(i));
+        }
+    }
+}
+
+void TypingBenchmark::fromScratch()
+{
+    QFETCH(int, length);
+    const QString prefix = QString::fromUtf8(TYPED_TEXT).left(length);
+
+    QList<Task*> result;
+    QBENCHMARK {
+        touch();
+        result = search(prefix);
+    }
+}
+
+QTEST_GUILESS_MAIN(TypingBenchmark)
+
+#include "typingbench.moc"
@@ -0,0 +1,9 @@
+# Поиск по мере набора: уточнение предыдущего результата против поиска с нуля
+
+include(../benchmarks.pri)
+
+TARGET = typingbench
+TEMPLATE = app
+
+SOURCES += \
+        typingbench.cpp
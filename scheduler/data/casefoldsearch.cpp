@@ -0,0 +1,151 @@
+#include "casefoldsearch.h"
+#include <QChar>
+#include <QtAlgorithms>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CASEFOLDSEARCH_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Свертка одной кодовой единицы: быстрые ветки для ASCII и кириллицы
+inline ushort foldUnit(ushort c)
+{
+    if (c < 0x80) {
+        return ushort(c - 'A') < 26 ? ushort(c + 0x20) : c;
+    }
+    if (c >= 0x400 && c < 0x460) {
+        if (c < 0x410) {
+            return ushort(c + 0x50); // Ѐ-Џ
+        }
+        return c < 0x430 ? ushort(c + 0x20) : c; // А-Я
+    }
+    return ushort(QChar::toCaseFolded(uint(c)));
+}
+
+template<bool FoldHaystack>
+inline ushort haystackUnit(ushort c)
+{
+    return FoldHaystack ? foldUnit(c) : c;
+}
+
+template<bool FoldHaystack>
+bool matchesAt(const ushort *haystack, const ushort *needle, int length)
+{
+    for (int j = 0; j < length; ++j) {
+        if (haystackUnit<FoldHaystack>(haystack[j]) != foldUnit(needle[j])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<bool FoldHaystack>
+bool scalarContains(const ushort *haystack, int size, const ushort *needle, int length, int from)
+{
+    const ushort first = foldUnit(needle[0]);
+    for (int i = from; i + length <= size; ++i) {
+        if (haystackUnit<FoldHaystack>(haystack[i]) == first &&
+            matchesAt<FoldHaystack>(haystack + i, needle, length)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef CASEFOLDSEARCH_SSE2
+
+// Маска элементов x из [lo, hi]: беззнаковое сравнение через вычитание с насыщением
+inline __m128i inRange(__m128i x, ushort lo, ushort hi)
+{
+    __m128i offset = _mm_sub_epi16(x, _mm_set1_epi16(short(lo)));
+    return _mm_cmpeq_epi16(_mm_subs_epu16(offset, _mm_set1_epi16(short(hi - lo))), _mm_setzero_si128());
+}
+
+// Свертка восьми кодовых единиц: A-Z и А-Я +0x20, Ѐ-Џ +0x50
+// В other - единицы вне ASCII и основного блока кириллицы, их сворачивает скалярный путь
+inline __m128i foldVector(__m128i x, __m128i &other)
+{
+    __m128i fast = _mm_or_si128(inRange(x, 0, 0x7F), inRange(x, 0x400, 0x45F));
+    other = _mm_xor_si128(fast, _mm_cmpeq_epi16(x, x));
+    __m128i by20 = _mm_or_si128(inRange(x, 'A', 'Z'), inRange(x, 0x410, 0x42F));
+    __m128i by50 = inRange(x, 0x400, 0x40F);
+    __m128i delta = _mm_or_si128(_mm_and_si128(by20, _mm_set1_epi16(0x20)),
+                                 _mm_and_si128(by50, _mm_set1_epi16(0x50)));
+    return _mm_add_epi16(x, delta);
+}
+
+// Фильтр по первой и последней единице образца для восьми позиций сразу,
+// полная проверка - только для позиций, где совпали обе
+template<bool FoldHaystack>
+bool vectorContains(const ushort *haystack, int size, const ushort *needle, int length)
+{
+    const ushort first = foldUnit(needle[0]);
+    const __m128i firstVector = _mm_set1_epi16(short(first));
+    const __m128i lastVector = _mm_set1_epi16(short(foldUnit(needle[length - 1])));
+    int i = 0;
+    for (; i + 8 + length - 1 <= size; i += 8) {
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i + length - 1));
+        if (FoldHaystack) {
+            __m128i headOther;
+            __m128i tailOther;
+            head = foldVector(head, headOther);
+            tail = foldVector(tail, tailOther);
+            if (_mm_movemask_epi8(_mm_or_si128(headOther, tailOther)) != 0) {
+                for (int j = i; j < i + 8; ++j) {
+                    if (foldUnit(haystack[j]) == first && matchesAt<true>(haystack + j, needle, length)) {
+                        return true;
+                    }
+                }
+                continue;
+            }
+        }
+        __m128i hits = _mm_and_si128(_mm_cmpeq_epi16(head, firstVector), _mm_cmpeq_epi16(tail, lastVector));
+        quint32 mask = quint32(_mm_movemask_epi8(hits));
+        while (mask != 0) {
+            // На каждую 16-битную позицию приходится два бита маски
+            int bit = int(qCountTrailingZeroBits(mask));
+            if (matchesAt<FoldHaystack>(haystack + i + bit / 2, needle, length)) {
+                return true;
+            }
+            mask &= ~(3u << bit);
+        }
+    }
+    return scalarContains<FoldHaystack>(haystack, size, needle, length, i);
+}
+
+#endif
+
+template<bool FoldHaystack>
+bool containsImpl(const QString &haystack, const QString &needle)
+{
+    const int length = needle.size();
+    const int size = haystack.size();
+    if (length == 0) {
+        return true;
+    }
+    if (length > size) {
+        return false;
+    }
+    const ushort *h = haystack.utf16();
+    const ushort *n = needle.utf16();
+#ifdef CASEFOLDSEARCH_SSE2
+    return vectorContains<FoldHaystack>(h, size, n, length);
+#else
+    return scalarContains<FoldHaystack>(h, size, n, length, 0);
+#endif
+}
+
+}
+
+bool CaseFoldSearch::contains(const QString &haystack, const QString &needle)
+{
+    return containsImpl<true>(haystack, needle);
+}
+
+bool CaseFoldSearch::containsFolded(const QString &foldedHaystack, const QString &needle)
+{
+    return containsImpl<false>(foldedHaystack, needle);
+}
@@ -0,0 +1,20 @@
+#ifndef CASEFOLDSEARCH_H
+#define CASEFOLDSEARCH_H
+
+#include <QString>
+
+// Поиск подстроки без учета регистра прямо по UTF-16, без временных строк
+// Латиница и основной блок кириллицы сворачиваются на лету векторно (SSE2,
+// по восемь кодовых единиц), остальные символы - QChar::toCaseFolded.
+// Результат совпадает с QString::contains(..., Qt::CaseInsensitive) для символов BMP;
+// суррогатные пары сравниваются как есть
+class CaseFoldSearch
+{
+public:
+    // Вхождение needle в haystack; обе строки сворачиваются на лету
+    static bool contains(const QString &haystack, const QString &needle);
+    // То же для haystack, уже свернутого toCaseFolded (например, Task::getFoldedTitle)
+    static bool containsFolded(const QString &foldedHaystack, const QString &needle);
+};
+
+#endif // CASEFOLDSEARCH_H
@@ -0,0 +1,160 @@
+#include "completionindex.h"
+#include <algorithm>
+
+CompletionIndex::CompletionIndex()
+    : m_dirty(false)
+{
+}
+
+void CompletionIndex::insert(const QString &key, const QString &text)
+{
+    Entry &entry = m_entries[key];
+    if (entry.count == 0) {
+        entry.text = text;
+    }
+    ++entry.count;
+    if (entry.position < 0) {
+        m_dirty = true;
+    } else if (!m_dirty) {
+        m_counts[entry.position] = entry.count;
+        update(entry.position);
+    }
+}
+
+// Ключ с нулевой частотой остается в массиве до перестроения и в подсказки не попадает
+void CompletionIndex::remove(const QString &key)
+{
+    QHash<QString, Entry>::iterator it = m_entries.find(key);
+    if (it == m_entries.end() || it->count == 0) {
+        return;
+    }
+    --it->count;
+    if (it->position >= 0 && !m_dirty) {
+        m_counts[it->position] = it->count;
+        update(it->position);
+    }
+}
+
+void CompletionIndex::clear()
+{
+    m_entries.clear();
+    m_keys.clear();
+    m_counts.clear();
+    m_tree.clear();
+    m_dirty = false;
+}
+
+void CompletionIndex::rebuild() const
+{
+    m_keys.clear();
+    for (QHash<QString, Entry>::iterator it = m_entries.begin(); it != m_entries.end();) {
+        if (it->count == 0) {
+            it = m_entries.erase(it);
+        } else {
+            m_keys.append(it.key());
+            ++it;
+        }
+    }
+    std::sort(m_keys.begin(), m_keys.end());
+
+    const int n = m_keys.size();
+    m_counts.resize(n);
+    for (int i = 0; i < n; ++i) {
+        Entry &entry = m_entries[m_keys.at(i)];
+        entry.position = i;
+        m_counts[i] = entry.count;
+    }
+    // Дерево снизу вверх: листья n..2n-1, узел i - лучший из 2i и 2i+1
+    m_tree.resize(2 * n);
+    for (int i = 0; i < n; ++i) {
+        m_tree[n + i] = i;
+    }
+    for (int i = n - 1; i > 0; --i) {
+        m_tree[i] = pick(m_tree.at(2 * i), m_tree.at(2 * i + 1));
+    }
+    m_dirty = false;
+}
+
+void CompletionIndex::update(int position) const
+{
+    const int n = m_keys.size();
+    for (int i = (position + n) / 2; i > 0; i /= 2) {
+        m_tree[i] = pick(m_tree.at(2 * i), m_tree.at(2 * i + 1));
+    }
+}
+
+int CompletionIndex::pick(int a, int b) const
+{
+    if (a < 0) {
+        return b;
+    }
+    if (b < 0) {
+        return a;
+    }
+    return better(a, b) ? a : b;
+}
+
+// Лучший ключ на полуинтервале [from, to), -1 для пустого
+int CompletionIndex::best(int from, int to) const
+{
+    const int n = m_keys.size();
+    int result = -1;
+    for (int l = from + n, r = to + n; l < r; l /= 2, r /= 2) {
+        if (l & 1) {
+            result = pick(result, m_tree.at(l++));
+        }
+        if (r & 1) {
+            result = pick(result, m_tree.at(--r));
+        }
+    }
+    return result;
+}
+
+QStringList CompletionIndex::complete(const QString &prefix, int limit) const
+{
+    QStringList result;
+    if (limit <= 0) {
+        return result;
+    }
+    if (m_dirty) {
+        rebuild();
+    }
+
+    QVector<QString>::const_iterator first = std::lower_bound(m_keys.constBegin(), m_keys.constEnd(), prefix);
+    QVector<QString>::const_iterator last = std::partition_point(first, m_keys.constEnd(),
+        [&prefix](const QString &key) { return key.startsWith(prefix); });
+
+    // Очередь отрезков по их лучшему ключу: взятый ключ делит свой отрезок на два
+    struct Range {
+        int best;
+        int from;
+        int to;
+    };
+    auto lower = [this](const Range &a, const Range &b) { return better(b.best, a.best); };
+    QVector<Range> heap;
+    int from = int(first - m_keys.constBegin());
+    int to = int(last - m_keys.constBegin());
+    if (from < to) {
+        Range whole = { best(from, to), from, to };
+        heap.append(whole);
+    }
+    while (!heap.isEmpty() && result.size() < limit) {
+        std::pop_heap(heap.begin(), heap.end(), lower);
+        Range range = heap.takeLast();
+        if (m_counts.at(range.best) == 0) {
+            break; // остальные отрезки не лучше
+        }
+        result.append(m_entries.value(m_keys.at(range.best)).text);
+        if (range.from < range.best) {
+            Range left = { best(range.from, range.best), range.from, range.best };
+            heap.append(left);
+            std::push_heap(heap.begin(), heap.end(), lower);
+        }
+        if (range.best + 1 < range.to) {
+            Range right = { best(range.best + 1, range.to), range.best + 1, range.to };
+            heap.append(right);
+            std::push_heap(heap.begin(), heap.end(), lower);
+        }
+    }
+    return result;
+}
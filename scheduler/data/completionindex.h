@@ -0,0 +1,50 @@
+#ifndef COMPLETIONINDEX_H
+#define COMPLETIONINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+
+// Дополнение по префиксу с ранжированием по частоте
+// Ключи (нормализованные строки) лежат в отсортированном массиве: ключи с общим
+// префиксом занимают непрерывный отрезок, который находится двоичным поиском.
+// Над частотами построено дерево отрезков максимумов, поэтому N лучших ключей
+// отрезка извлекаются за O(N log n) без просмотра всего отрезка.
+// Изменение частоты известного ключа (в том числе до нуля) правит дерево на месте,
+// новый ключ откладывает перестроение массива до следующего запроса
+class CompletionIndex
+{
+public:
+    CompletionIndex();
+
+    // Вхождение строки text с ключом key; text показывается в подсказке
+    void insert(const QString &key, const QString &text);
+    void remove(const QString &key);
+    void clear();
+
+    // До limit строк, ключ которых начинается с prefix, по убыванию частоты,
+    // при равной частоте - по ключу. prefix нормализуется так же, как ключи
+    QStringList complete(const QString &prefix, int limit) const;
+
+private:
+    struct Entry {
+        QString text;
+        int count = 0;
+        int position = -1; // индекс в m_keys, -1 - ключ добавлен после перестроения
+    };
+
+    void rebuild() const;
+    void update(int position) const;
+    int best(int from, int to) const;
+    int pick(int a, int b) const;
+    bool better(int a, int b) const { return m_counts.at(a) != m_counts.at(b) ? m_counts.at(a) > m_counts.at(b) : a < b; }
+
+    mutable QHash<QString, Entry> m_entries; // ключи с нулевой частотой убирает rebuild
+    mutable QVector<QString> m_keys;
+    mutable QVector<int> m_counts;
+    mutable QVector<int> m_tree; // узел - индекс ключа с наибольшей частотой в поддереве
+    mutable bool m_dirty;
+};
+
+#endif // COMPLETIONINDEX_H
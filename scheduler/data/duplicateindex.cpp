@@ -0,0 +1,287 @@
+#include "duplicateindex.h"
+#include "slotstore.h"
+#include <algorithm>
+
+namespace {
+
+quint64 splitMix(quint64 &state)
+{
+    quint64 z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Перемешивание тройки символов перед хеш-функциями семейства
+quint64 mix(quint64 x)
+{
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    return x ^ (x >> 33);
+}
+
+// Семейство хеш-функций h(x) = (a * x + b) >> 32 с нечетным a,
+// коэффициенты фиксированы, чтобы подписи не зависели от запуска
+struct HashFamily {
+    quint64 a[DuplicateIndex::HASH_COUNT];
+    quint64 b[DuplicateIndex::HASH_COUNT];
+
+    HashFamily()
+    {
+        quint64 state = 0x5EED;
+        for (int i = 0; i < DuplicateIndex::HASH_COUNT; ++i) {
+            a[i] = splitMix(state) | 1;
+            b[i] = splitMix(state);
+        }
+    }
+};
+
+const HashFamily &hashFamily()
+{
+    static const HashFamily family;
+    return family;
+}
+
+// Слова через один пробел, с пробелами по краям - тройки захватывают границы слов
+QString normalize(const QString &title)
+{
+    QString folded = title.toCaseFolded();
+    QString result(QLatin1Char(' '));
+    result.reserve(folded.size() + 2);
+    for (QChar c : folded) {
+        if (c.isLetterOrNumber()) {
+            result.append(c == QChar(0x451) ? QChar(0x435) : c); // ё -> е
+        } else if (!result.endsWith(QLatin1Char(' '))) {
+            result.append(QLatin1Char(' '));
+        }
+    }
+    if (!result.endsWith(QLatin1Char(' '))) {
+        result.append(QLatin1Char(' '));
+    }
+    return result;
+}
+
+}
+
+// Хранятся старшие 16 бит каждого минимума (b-bit MinHash): случайное совпадение
+// усеченных значений добавляет к оценке не больше 1/65536, а подпись вчетверо короче
+bool DuplicateIndex::signature(const QString &title, Signature &result)
+{
+    QString text = normalize(title);
+    if (text.size() < 3) {
+        return false; // в названии нет ни букв, ни цифр
+    }
+    const HashFamily &family = hashFamily();
+    quint32 minimums[HASH_COUNT];
+    std::fill(minimums, minimums + HASH_COUNT, quint32(0xFFFFFFFF));
+    const ushort *units = text.utf16();
+    for (int i = 0; i + 3 <= text.size(); ++i) {
+        quint64 gram = mix((quint64(units[i]) << 32) | (quint64(units[i + 1]) << 16) | units[i + 2]);
+        for (int k = 0; k < HASH_COUNT; ++k) {
+            quint32 value = quint32((family.a[k] * gram + family.b[k]) >> 32);
+            minimums[k] = qMin(minimums[k], value);
+        }
+    }
+    result.resize(HASH_COUNT);
+    for (int k = 0; k < HASH_COUNT; ++k) {
+        result[k] = quint16(minimums[k] >> 16);
+    }
+    return true;
+}
+
+quint64 DuplicateIndex::bandKey(const quint16 *signature, int band)
+{
+    quint64 key = 0;
+    for (int row = 0; row < ROWS; ++row) {
+        key = (key << 16) | signature[band * ROWS + row];
+    }
+    return key;
+}
+
+double DuplicateIndex::similarity(const quint16 *first, const quint16 *second)
+{
+    int equal = 0;
+    for (int k = 0; k < HASH_COUNT; ++k) {
+        if (first[k] == second[k]) {
+            ++equal;
+        }
+    }
+    return double(equal) / HASH_COUNT;
+}
+
+const quint16 *DuplicateIndex::signatureAt(int slot) const
+{
+    return m_signatures.constData() + slot * HASH_COUNT;
+}
+
+double DuplicateIndex::similarity(int first, int second) const
+{
+    if (first < 0 || second < 0 || first >= m_indexed.size() || second >= m_indexed.size() ||
+        !m_indexed.at(first) || !m_indexed.at(second)) {
+        return 0;
+    }
+    return similarity(signatureAt(first), signatureAt(second));
+}
+
+void DuplicateIndex::insert(int slot, const QString &title)
+{
+    if (slot < m_indexed.size() && m_indexed.at(slot)) {
+        remove(slot);
+    }
+    Signature values;
+    if (!signature(title, values)) {
+        return;
+    }
+    if (slot >= m_indexed.size()) {
+        m_indexed.resize(slot + 1);
+        m_signatures.resize((slot + 1) * HASH_COUNT);
+    }
+    if (m_buckets.isEmpty()) {
+        m_buckets.resize(BANDS);
+    }
+    std::copy(values.constBegin(), values.constEnd(), m_signatures.begin() + slot * HASH_COUNT);
+    m_indexed[slot] = true;
+    for (int band = 0; band < BANDS; ++band) {
+        m_buckets[band][bandKey(values.constData(), band)].append(slot);
+    }
+}
+
+void DuplicateIndex::remove(int slot)
+{
+    if (slot < 0 || slot >= m_indexed.size() || !m_indexed.at(slot)) {
+        return;
+    }
+    const quint16 *values = signatureAt(slot);
+    for (int band = 0; band < BANDS; ++band) {
+        QHash<quint64, QVector<int>>::iterator it = m_buckets[band].find(bandKey(values, band));
+        if (it == m_buckets[band].end()) {
+            continue;
+        }
+        it.value().removeOne(slot);
+        if (it.value().isEmpty()) {
+            m_buckets[band].erase(it);
+        }
+    }
+    m_indexed[slot] = false;
+}
+
+void DuplicateIndex::clear()
+{
+    m_signatures.clear();
+    m_indexed.clear();
+    m_buckets.clear();
+}
+
+void DuplicateIndex::remap(const QVector<int> &slots)
+{
+    int size = 0;
+    for (int slot = 0; slot < m_indexed.size(); ++slot) {
+        int mapped = slot < slots.size() ? slots.at(slot) : -1;
+        if (mapped < 0) {
+            continue;
+        }
+        // Новый номер не больше старого - перенос на месте ничего не затирает
+        m_indexed[mapped] = m_indexed.at(slot);
+        for (int k = 0; k < HASH_COUNT; ++k) {
+            m_signatures[mapped * HASH_COUNT + k] = m_signatures.at(slot * HASH_COUNT + k);
+        }
+        size = mapped + 1;
+    }
+    m_indexed.resize(size);
+    m_signatures.resize(size * HASH_COUNT);
+    for (QHash<quint64, QVector<int>> &buckets : m_buckets) {
+        for (QHash<quint64, QVector<int>>::iterator it = buckets.begin(); it != buckets.end();) {
+            remapSlots(it.value(), slots);
+            if (it.value().isEmpty()) {
+                it = buckets.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+QVector<int> DuplicateIndex::similarTo(const QString &title, double threshold) const
+{
+    QVector<int> result;
+    Signature values;
+    if (m_buckets.isEmpty() || !signature(title, values)) {
+        return result;
+    }
+    QVector<int> candidates;
+    for (int band = 0; band < BANDS; ++band) {
+        candidates += m_buckets.at(band).value(bandKey(values.constData(), band));
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    for (int slot : candidates) {
+        if (similarity(values.constData(), signatureAt(slot)) >= threshold) {
+            result.append(slot);
+        }
+    }
+    return result;
+}
+
+// Кандидаты - только пары из общих корзин. Внутри корзины каждый слот сравнивается
+// с первым и с предыдущим: этого хватает, чтобы связать группу, и корзина
+// одинаковых названий обходится за линейное время
+QVector<QVector<int>> DuplicateIndex::clusters(double threshold) const
+{
+    QVector<int> parent(m_indexed.size());
+    for (int i = 0; i < parent.size(); ++i) {
+        parent[i] = i;
+    }
+    auto find = [&parent](int slot) {
+        while (parent.at(slot) != slot) {
+            parent[slot] = parent.at(parent.at(slot));
+            slot = parent.at(slot);
+        }
+        return slot;
+    };
+    auto unite = [&parent, &find](int first, int second) {
+        int a = find(first);
+        int b = find(second);
+        if (a != b) {
+            parent[qMax(a, b)] = qMin(a, b);
+        }
+    };
+
+    for (const QHash<quint64, QVector<int>> &buckets : m_buckets) {
+        for (QHash<quint64, QVector<int>>::const_iterator it = buckets.constBegin(); it != buckets.constEnd(); ++it) {
+            const QVector<int> &members = it.value();
+            for (int i = 1; i < members.size(); ++i) {
+                int slot = members.at(i);
+                if (find(slot) == find(members.at(0))) {
+                    continue;
+                }
+                if (similarity(signatureAt(slot), signatureAt(members.at(0))) >= threshold) {
+                    unite(slot, members.at(0));
+                } else if (similarity(signatureAt(slot), signatureAt(members.at(i - 1))) >= threshold) {
+                    unite(slot, members.at(i - 1));
+                }
+            }
+        }
+    }
+
+    QHash<int, QVector<int>> groups;
+    for (int slot = 0; slot < m_indexed.size(); ++slot) {
+        if (m_indexed.at(slot) && find(slot) != slot) {
+            QVector<int> &group = groups[find(slot)];
+            if (group.isEmpty()) {
+                group.append(find(slot));
+            }
+            group.append(slot);
+        }
+    }
+    QVector<QVector<int>> result;
+    result.reserve(groups.size());
+    for (QHash<int, QVector<int>>::const_iterator it = groups.constBegin(); it != groups.constEnd(); ++it) {
+        result.append(it.value());
+    }
+    std::sort(result.begin(), result.end(), [](const QVector<int> &a, const QVector<int> &b) {
+        return a.size() != b.size() ? a.size() > b.size() : a.first() < b.first();
+    });
+    return result;
+}
@@ -0,0 +1,51 @@
+#ifndef DUPLICATEINDEX_H
+#define DUPLICATEINDEX_H
+
+#include <QString>
+#include <QHash>
+#include <QVector>
+
+// Поиск почти одинаковых названий задач: MinHash + LSH
+// Название нормализуется (свернутый регистр, ё -> е, знаки препинания -> пробел)
+// и разбивается на тройки символов. Подпись - минимумы HASH_COUNT хеш-функций
+// по тройкам, доля совпавших минимумов оценивает коэффициент Жаккара множеств.
+// Подпись режется на BANDS полос по ROWS значений; названия с одинаковой полосой
+// попадают в одну корзину - кандидаты сравниваются только внутри корзин,
+// без попарного перебора всех задач. Похожие на 0.65 названия становятся
+// кандидатами с вероятностью ~0.95, на 0.3 - ~0.12
+class DuplicateIndex
+{
+public:
+    static const int BANDS = 16;
+    static const int ROWS = 4;
+    static const int HASH_COUNT = BANDS * ROWS;
+
+    void insert(int slot, const QString &title);
+    void remove(int slot);
+    void clear();
+    // Перенумерация слотов после уплотнения хранилища (см. SlotStore::compact)
+    void remap(const QVector<int> &slots);
+
+    // Оценка сходства двух проиндексированных названий (0..1)
+    double similarity(int first, int second) const;
+    // Слоты с названием, похожим на title не меньше чем на threshold
+    QVector<int> similarTo(const QString &title, double threshold) const;
+    // Группы слотов похожих названий (не меньше двух в группе), большие первыми
+    // Похожесть транзитивна внутри группы: A~B и B~C объединяют A, B и C
+    QVector<QVector<int>> clusters(double threshold) const;
+
+private:
+    typedef QVector<quint16> Signature;
+
+    static bool signature(const QString &title, Signature &result);
+    static quint64 bandKey(const quint16 *signature, int band);
+    static double similarity(const quint16 *first, const quint16 *second);
+    const quint16 *signatureAt(int slot) const;
+
+    // Подписи по слотам подряд; для слота без подписи m_indexed[slot] == false
+    QVector<quint16> m_signatures;
+    QVector<bool> m_indexed;
+    QVector<QHash<quint64, QVector<int>>> m_buckets; // по полосам
+};
+
+#endif // DUPLICATEINDEX_H
@@ -0,0 +1,185 @@
+#ifndef FILTERCOMBINATORS_H
+#define FILTERCOMBINATORS_H
+
+#include "strategies.h"
+#include "casefoldsearch.h"
+#include "../models/task.h"
+#include <QList>
+#include <QDate>
+#include <QString>
+
+class User;
+class Project;
+
+// Комбинаторы фильтров времени компиляции
+// Предикат - любой тип с bool operator()(Task*) const. And<>, Or<>, Not<> собирают
+// из предикатов один тип, который компилятор встраивает в единственный цикл:
+// без виртуальных вызовов и без промежуточного списка на каждом условии.
+// Пример: TaskService::filterTasks(TaskFilter::all(TaskFilter::PriorityIs{Priority::High},
+//                                                  TaskFilter::negate(TaskFilter::CompletedIs{true})))
+namespace TaskFilter {
+
+struct PriorityIs {
+    Priority priority;
+    bool operator()(Task *task) const { return task->getPriority() == priority; }
+};
+
+struct OwnerIs {
+    User *owner;
+    bool operator()(Task *task) const { return task->getOwner() == owner; }
+};
+
+struct ProjectIs {
+    Project *project;
+    bool operator()(Task *task) const { return task->getProject() == project; }
+};
+
+struct CompletedIs {
+    bool completed;
+    bool operator()(Task *task) const { return task->isCompleted() == completed; }
+};
+
+struct DueOn {
+    QDate day;
+    bool operator()(Task *task) const { return task->getDeadline().date() == day; }
+};
+
+struct TitleContains {
+    QString keyword;
+    bool operator()(Task *task) const { return CaseFoldSearch::containsFolded(task->getFoldedTitle(), keyword); }
+};
+
+// Стратегия-предикат внутри составного предиката (один виртуальный вызов на задачу)
+struct StrategyMatches {
+    const PredicateFilterStrategy *strategy;
+    bool operator()(Task *task) const { return strategy->matches(task); }
+};
+
+// Условие, которое включается во время выполнения (например, фильтр из FilterOptions):
+// выключенное пропускает любую задачу, а тип составного предиката от этого не меняется
+template<typename Predicate>
+class When
+{
+public:
+    When(bool enabled, const Predicate &predicate) : m_enabled(enabled), m_predicate(predicate) {}
+    bool operator()(Task *task) const { return !m_enabled || m_predicate(task); }
+
+private:
+    bool m_enabled;
+    Predicate m_predicate;
+};
+
+template<typename... Predicates>
+class And;
+
+template<>
+class And<>
+{
+public:
+    bool operator()(Task *) const { return true; }
+};
+
+template<typename First, typename... Rest>
+class And<First, Rest...>
+{
+public:
+    explicit And(const First &first, const Rest &... rest) : m_first(first), m_rest(rest...) {}
+    bool operator()(Task *task) const { return m_first(task) && m_rest(task); }
+
+private:
+    First m_first;
+    And<Rest...> m_rest;
+};
+
+template<typename... Predicates>
+class Or;
+
+template<>
+class Or<>
+{
+public:
+    bool operator()(Task *) const { return false; }
+};
+
+template<typename First, typename... Rest>
+class Or<First, Rest...>
+{
+public:
+    explicit Or(const First &first, const Rest &... rest) : m_first(first), m_rest(rest...) {}
+    bool operator()(Task *task) const { return m_first(task) || m_rest(task); }
+
+private:
+    First m_first;
+    Or<Rest...> m_rest;
+};
+
+template<typename Predicate>
+class Not
+{
+public:
+    explicit Not(const Predicate &predicate) : m_predicate(predicate) {}
+    bool operator()(Task *task) const { return !m_predicate(task); }
+
+private:
+    Predicate m_predicate;
+};
+
+// Фабрики - выводят типы аргументов, чтобы не выписывать их вручную
+template<typename... Predicates>
+And<Predicates...> all(const Predicates &... predicates)
+{
+    return And<Predicates...>(predicates...);
+}
+
+template<typename... Predicates>
+Or<Predicates...> any(const Predicates &... predicates)
+{
+    return Or<Predicates...>(predicates...);
+}
+
+template<typename Predicate>
+Not<Predicate> negate(const Predicate &predicate)
+{
+    return Not<Predicate>(predicate);
+}
+
+template<typename Predicate>
+When<Predicate> when(bool enabled, const Predicate &predicate)
+{
+    return When<Predicate>(enabled, predicate);
+}
+
+// Единственный проход по списку с проверкой составного предиката
+template<typename Predicate>
+QList<Task*> apply(const QList<Task*> &tasks, const Predicate &predicate)
+{
+    QList<Task*> result;
+    for (Task *task : tasks) {
+        if (predicate(task)) {
+            result.append(task);
+        }
+    }
+    return result;
+}
+
+// Адаптер: составной предикат как стратегия, для кода, работающего с IFilterStrategy
+template<typename Predicate>
+class FusedFilterStrategy : public PredicateFilterStrategy
+{
+public:
+    explicit FusedFilterStrategy(const Predicate &predicate) : m_predicate(predicate) {}
+    bool matches(Task *task) const override { return m_predicate(task); }
+
+private:
+    Predicate m_predicate;
+};
+
+template<typename Predicate>
+FusedFilterStrategy<Predicate> *makeStrategy(const Predicate &predicate)
+{
+    return new FusedFilterStrategy<Predicate>(predicate);
+}
+
+}
+
+#endif // FILTERCOMBINATORS_H
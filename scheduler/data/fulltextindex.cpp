@@ -0,0 +1,425 @@
+#include "fulltextindex.h"
+#include "slotstore.h"
+#include <QChar>
+#include <QPair>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace {
+
+// Параметры BM25: насыщение частоты и нормализация по длине документа
+const double K1 = 1.2;
+const double B = 0.75;
+// Запас на погрешность округления: оценка сверху не должна оказаться меньше точного веса
+const double BOUND_SLACK = 1.0 + 1e-6;
+
+typedef FullTextIndex::Hit Hit;
+
+// Лучший результат - с большим весом, при равенстве - с меньшим слотом
+bool betterHit(const Hit &a, const Hit &b)
+{
+    return a.score > b.score || (a.score == b.score && a.slot < b.slot);
+}
+
+// Куча из limit лучших результатов; на вершине - худший из них
+class TopHits
+{
+public:
+    explicit TopHits(int limit) : m_limit(limit) { m_heap.reserve(limit); }
+
+    bool isFull() const { return m_heap.size() >= m_limit; }
+    double threshold() const { return isFull() ? m_heap.first().score : 0.0; }
+
+    void offer(const Hit &hit)
+    {
+        if (!isFull()) {
+            m_heap.append(hit);
+            std::push_heap(m_heap.begin(), m_heap.end(), betterHit);
+        } else if (betterHit(hit, m_heap.first())) {
+            std::pop_heap(m_heap.begin(), m_heap.end(), betterHit);
+            m_heap.last() = hit;
+            std::push_heap(m_heap.begin(), m_heap.end(), betterHit);
+        }
+    }
+
+    QVector<Hit> take()
+    {
+        std::sort(m_heap.begin(), m_heap.end(), betterHit);
+        return m_heap;
+    }
+
+private:
+    QVector<Hit> m_heap;
+    int m_limit;
+};
+
+}
+
+// Курсор по спискам вхождений одного слова запроса
+class FullTextIndex::Cursor
+{
+public:
+    static const int END = std::numeric_limits<int>::max();
+
+    Cursor(const Postings *postings, double idf, double bound)
+        : idf(idf), bound(bound), m_postings(postings), m_index(0) {}
+
+    int slot() const { return m_index < m_postings->slots.size() ? m_postings->slots.at(m_index) : END; }
+    float weight() const { return m_postings->weights.at(m_index); }
+    void next() { ++m_index; }
+    // Переход к первому слоту не меньше заданного
+    void seek(int slot)
+    {
+        const QVector<int> &slots = m_postings->slots;
+        m_index = int(std::lower_bound(slots.constBegin() + m_index, slots.constEnd(), slot) - slots.constBegin());
+    }
+
+    double idf;
+    double bound;
+
+private:
+    const Postings *m_postings;
+    int m_index;
+};
+
+FullTextIndex::FullTextIndex()
+    : m_documentCount(0), m_totalLength(0)
+{
+}
+
+QStringList FullTextIndex::tokenize(const QString &text)
+{
+    QStringList tokens;
+    QString token;
+    for (QChar c : text) {
+        if (c.isLetterOrNumber()) {
+            token.append(c.toCaseFolded());
+        } else if (!token.isEmpty()) {
+            tokens.append(token);
+            token.clear();
+        }
+    }
+    if (!token.isEmpty()) {
+        tokens.append(token);
+    }
+    return tokens;
+}
+
+int FullTextIndex::termId(const QString &term)
+{
+    QHash<QString, int>::const_iterator it = m_termIds.constFind(term);
+    if (it != m_termIds.constEnd()) {
+        return it.value();
+    }
+    int id = m_postings.size();
+    m_termIds.insert(term, id);
+    m_postings.append(Postings());
+    return id;
+}
+
+// Позиции слов названия идут с нуля, описания - после пропуска,
+// чтобы фраза не склеивалась из конца названия и начала описания
+void FullTextIndex::insert(int slot, const QString &title, const QString &description)
+{
+    remove(slot);
+
+    QHash<int, QPair<float, QVector<int>>> occurrences;
+    QStringList titleTokens = tokenize(title);
+    QStringList descriptionTokens = tokenize(description);
+    for (int i = 0; i < titleTokens.size(); ++i) {
+        QPair<float, QVector<int>> &entry = occurrences[termId(titleTokens.at(i))];
+        entry.first += TITLE_WEIGHT;
+        entry.second.append(i);
+    }
+    const int descriptionStart = titleTokens.size() + 1;
+    for (int i = 0; i < descriptionTokens.size(); ++i) {
+        QPair<float, QVector<int>> &entry = occurrences[termId(descriptionTokens.at(i))];
+        entry.first += 1;
+        entry.second.append(descriptionStart + i);
+    }
+    if (occurrences.isEmpty()) {
+        return;
+    }
+
+    if (m_documents.size() <= slot) {
+        m_documents.resize(slot + 1);
+    }
+    Document &document = m_documents[slot];
+    document.terms.reserve(occurrences.size());
+
+    for (QHash<int, QPair<float, QVector<int>>>::const_iterator it = occurrences.constBegin();
+         it != occurrences.constEnd(); ++it) {
+        Postings &postings = m_postings[it.key()];
+        const float weight = it.value().first;
+        const QVector<int> &positions = it.value().second;
+        if (postings.offsets.isEmpty()) {
+            postings.offsets.append(0);
+        }
+        // Новые задачи получают наибольший слот - обычно это добавление в конец
+        int index = postings.slots.size();
+        if (!postings.slots.isEmpty() && postings.slots.last() > slot) {
+            index = int(std::lower_bound(postings.slots.begin(), postings.slots.end(), slot) - postings.slots.begin());
+        }
+        int start = postings.offsets.at(index);
+        postings.slots.insert(index, slot);
+        postings.weights.insert(index, weight);
+        postings.positions.insert(start, positions.size(), 0);
+        std::copy(positions.constBegin(), positions.constEnd(), postings.positions.begin() + start);
+        postings.offsets.insert(index + 1, start + positions.size());
+        for (int i = index + 2; i < postings.offsets.size(); ++i) {
+            postings.offsets[i] += positions.size();
+        }
+        postings.maxWeight = qMax(postings.maxWeight, weight);
+
+        document.terms.append(it.key());
+        document.length += weight;
+    }
+
+    ++m_documentCount;
+    m_totalLength += document.length;
+}
+
+void FullTextIndex::remove(int slot)
+{
+    if (slot < 0 || slot >= m_documents.size() || m_documents.at(slot).length == 0) {
+        return;
+    }
+    Document &document = m_documents[slot];
+    for (int term : document.terms) {
+        Postings &postings = m_postings[term];
+        QVector<int>::iterator it = std::lower_bound(postings.slots.begin(), postings.slots.end(), slot);
+        if (it == postings.slots.end() || *it != slot) {
+            continue;
+        }
+        int index = int(it - postings.slots.begin());
+        int start = postings.offsets.at(index);
+        int count = postings.offsets.at(index + 1) - start;
+        postings.slots.remove(index);
+        postings.weights.remove(index);
+        postings.positions.remove(start, count);
+        postings.offsets.remove(index + 1);
+        for (int i = index + 1; i < postings.offsets.size(); ++i) {
+            postings.offsets[i] -= count;
+        }
+        if (postings.slots.isEmpty()) {
+            postings = Postings();
+        }
+    }
+    --m_documentCount;
+    m_totalLength -= document.length;
+    document = Document();
+}
+
+// Вхождения удаленных документов уже убраны из списков, поэтому веса и позиции
+// переносятся без изменений - меняются только номера слотов
+void FullTextIndex::remap(const QVector<int> &slots)
+{
+    QVector<int> termIds(m_postings.size(), -1);
+    QVector<Postings> postings;
+    for (int term = 0; term < m_postings.size(); ++term) {
+        if (m_postings.at(term).slots.isEmpty()) {
+            continue;
+        }
+        termIds[term] = postings.size();
+        postings.append(m_postings.at(term));
+        remapSlots(postings.last().slots, slots);
+    }
+    for (QHash<QString, int>::iterator it = m_termIds.begin(); it != m_termIds.end();) {
+        int id = termIds.at(it.value());
+        if (id < 0) {
+            it = m_termIds.erase(it);
+        } else {
+            it.value() = id;
+            ++it;
+        }
+    }
+    m_postings = postings;
+
+    QVector<Document> documents;
+    for (int slot = 0; slot < m_documents.size(); ++slot) {
+        int mapped = slot < slots.size() ? slots.at(slot) : -1;
+        if (mapped < 0 || m_documents.at(slot).length == 0) {
+            continue;
+        }
+        if (documents.size() <= mapped) {
+            documents.resize(mapped + 1);
+        }
+        Document &document = documents[mapped];
+        document = m_documents.at(slot);
+        for (int &term : document.terms) {
+            term = termIds.at(term);
+        }
+    }
+    m_documents = documents;
+}
+
+void FullTextIndex::clear()
+{
+    m_termIds.clear();
+    m_postings.clear();
+    m_documents.clear();
+    m_documentCount = 0;
+    m_totalLength = 0;
+}
+
+double FullTextIndex::idf(int documentFrequency) const
+{
+    return std::log(1.0 + (m_documentCount - documentFrequency + 0.5) / (documentFrequency + 0.5));
+}
+
+double FullTextIndex::termScore(float weight, float length, double idf, double averageLength)
+{
+    return idf * weight * (K1 + 1) / (weight + K1 * (1 - B + B * length / averageLength));
+}
+
+const int *FullTextIndex::positionsOf(int term, int slot, int &count) const
+{
+    const Postings &postings = m_postings.at(term);
+    QVector<int>::const_iterator it = std::lower_bound(postings.slots.constBegin(), postings.slots.constEnd(), slot);
+    if (it == postings.slots.constEnd() || *it != slot) {
+        count = 0;
+        return nullptr;
+    }
+    int index = int(it - postings.slots.constBegin());
+    count = postings.offsets.at(index + 1) - postings.offsets.at(index);
+    return postings.positions.constData() + postings.offsets.at(index);
+}
+
+// Фраза есть, если для некоторой позиции p первого слова k-е слово стоит на p + k
+bool FullTextIndex::containsPhrase(int slot, const QVector<int> &phrase) const
+{
+    int firstCount = 0;
+    const int *first = positionsOf(phrase.first(), slot, firstCount);
+    for (int i = 0; i < firstCount; ++i) {
+        bool found = true;
+        for (int k = 1; k < phrase.size() && found; ++k) {
+            int count = 0;
+            const int *positions = positionsOf(phrase.at(k), slot, count);
+            found = std::binary_search(positions, positions + count, first[i] + k);
+        }
+        if (found) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QVector<FullTextIndex::Hit> FullTextIndex::search(const QString &query, int limit) const
+{
+    if (limit <= 0 || m_documentCount == 0) {
+        return QVector<Hit>();
+    }
+
+    // Части запроса между кавычками (нечетные) - фразы, остальное - отдельные слова
+    QVector<int> terms;
+    QVector<QVector<int>> phrases;
+    QStringList parts = query.split(QLatin1Char('"'));
+    for (int i = 0; i < parts.size(); ++i) {
+        QVector<int> phrase;
+        for (const QString &token : tokenize(parts.at(i))) {
+            int id = m_termIds.value(token, -1);
+            bool known = id >= 0 && !m_postings.at(id).slots.isEmpty();
+            if (i % 2 == 1 && !known) {
+                // Слова фразы нет ни в одном документе - фраза не встретится
+                return QVector<Hit>();
+            }
+            if (known) {
+                phrase.append(id);
+                if (!terms.contains(id)) {
+                    terms.append(id);
+                }
+            }
+        }
+        if (i % 2 == 1 && !phrase.isEmpty()) {
+            phrases.append(phrase);
+        }
+    }
+    if (terms.isEmpty()) {
+        return QVector<Hit>();
+    }
+
+    const double averageLength = m_totalLength / m_documentCount;
+    QVector<Cursor> cursors;
+    cursors.reserve(terms.size());
+    for (int term : terms) {
+        const Postings &postings = m_postings.at(term);
+        double termIdf = idf(postings.slots.size());
+        // Вклад растет с весом, а длина документа не меньше веса слова в нем
+        double bound = termScore(postings.maxWeight, postings.maxWeight, termIdf, averageLength) * BOUND_SLACK;
+        cursors.append(Cursor(&postings, termIdf, bound));
+    }
+
+    TopHits top(limit);
+
+    if (!phrases.isEmpty()) {
+        // Фразы обязательны: кандидаты - документы самого редкого слова фраз,
+        // содержащие все слова фраз подряд; считаются только они
+        int rarest = phrases.first().first();
+        for (const QVector<int> &phrase : phrases) {
+            for (int term : phrase) {
+                if (m_postings.at(term).slots.size() < m_postings.at(rarest).slots.size()) {
+                    rarest = term;
+                }
+            }
+        }
+        for (int slot : m_postings.at(rarest).slots) {
+            bool matches = true;
+            for (int i = 0; i < phrases.size() && matches; ++i) {
+                matches = containsPhrase(slot, phrases.at(i));
+            }
+            if (!matches) {
+                continue;
+            }
+            const float length = m_documents.at(slot).length;
+            Hit hit = { slot, 0.0 };
+            for (int i = 0; i < cursors.size(); ++i) {
+                Cursor &cursor = cursors[i];
+                cursor.seek(slot);
+                if (cursor.slot() == slot) {
+                    hit.score += termScore(cursor.weight(), length, cursor.idf, averageLength);
+                }
+            }
+            top.offer(hit);
+        }
+        return top.take();
+    }
+
+    // WAND: курсоры упорядочены по текущему слоту; опорный - первый, на котором сумма
+    // оценок сверху превышает порог K-го результата. Документы до опорного слота
+    // содержат только слова перед ним и порог не превысят - их пропускаем целиком
+    while (true) {
+        std::sort(cursors.begin(), cursors.end(), [](const Cursor &a, const Cursor &b) {
+            return a.slot() < b.slot();
+        });
+        const double threshold = top.threshold();
+        double bounds = 0;
+        int pivot = -1;
+        for (int i = 0; i < cursors.size() && cursors.at(i).slot() != Cursor::END; ++i) {
+            bounds += cursors.at(i).bound;
+            if (bounds > threshold) {
+                pivot = i;
+                break;
+            }
+        }
+        if (pivot < 0) {
+            break;
+        }
+
+        const int pivotSlot = cursors.at(pivot).slot();
+        if (cursors.first().slot() == pivotSlot) {
+            const float length = m_documents.at(pivotSlot).length;
+            Hit hit = { pivotSlot, 0.0 };
+            for (int i = 0; i < cursors.size() && cursors.at(i).slot() == pivotSlot; ++i) {
+                hit.score += termScore(cursors.at(i).weight(), length, cursors.at(i).idf, averageLength);
+                cursors[i].next();
+            }
+            top.offer(hit);
+        } else {
+            for (int i = 0; i < pivot; ++i) {
+                cursors[i].seek(pivotSlot);
+            }
+        }
+    }
+    return top.take();
+}
@@ -0,0 +1,73 @@
+#ifndef FULLTEXTINDEX_H
+#define FULLTEXTINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+
+// Полнотекстовый индекс названий и описаний задач с ранжированием BM25
+// Текст разбивается на слова (буквы и цифры) в свернутом регистре; для каждого слова
+// хранится отсортированный по слотам список вхождений с позициями (для фраз).
+// Слово в названии весит TITLE_WEIGHT вхождений в описании.
+// Лучшие K документов отбираются алгоритмом WAND: по верхней оценке вклада каждого
+// слова пропускаются документы, которые заведомо не попадут в K, - без их подсчета
+class FullTextIndex
+{
+public:
+    struct Hit {
+        int slot;
+        double score;
+    };
+
+    FullTextIndex();
+
+    void insert(int slot, const QString &title, const QString &description);
+    void remove(int slot);
+    void clear();
+    // Перенумерация слотов после уплотнения хранилища; слова без вхождений
+    // при этом выбрасываются из словаря
+    void remap(const QVector<int> &slots);
+
+    // До limit документов по убыванию релевантности (при равенстве - по слоту)
+    // Слова запроса объединяются по ИЛИ; слова в кавычках - фраза, которая должна
+    // встретиться подряд в названии или в описании
+    QVector<Hit> search(const QString &query, int limit) const;
+
+    // Слова текста в свернутом регистре
+    static QStringList tokenize(const QString &text);
+
+private:
+    static const int TITLE_WEIGHT = 2;
+
+    // Вхождения слова: слоты по возрастанию, вес (взвешенная частота) и
+    // позиции каждого документа - отрезок [offsets[i], offsets[i + 1]) в positions
+    struct Postings {
+        QVector<int> slots;
+        QVector<float> weights;
+        QVector<int> offsets;
+        QVector<int> positions;
+        float maxWeight = 0; // только растет, поэтому остается верхней оценкой
+    };
+
+    struct Document {
+        float length = 0;   // сумма весов слов, 0 - слот свободен
+        QVector<int> terms; // различные слова документа, для удаления
+    };
+
+    class Cursor;
+
+    int termId(const QString &term);
+    double idf(int documentFrequency) const;
+    static double termScore(float weight, float length, double idf, double averageLength);
+    bool containsPhrase(int slot, const QVector<int> &phrase) const;
+    const int *positionsOf(int term, int slot, int &count) const;
+
+    QHash<QString, int> m_termIds;
+    QVector<Postings> m_postings;
+    QVector<Document> m_documents;
+    int m_documentCount;
+    double m_totalLength;
+};
+
+#endif // FULLTEXTINDEX_H
@@ -0,0 +1,284 @@
+#include "fuzzyindex.h"
+#include "fulltextindex.h"
+#include "slotstore.h"
+#include <QStringList>
+#include <algorithm>
+#include <limits>
+
+FuzzyMatcher::FuzzyMatcher(const QString &word, int maxDistance, bool prefix)
+    : m_word(word), m_maxDistance(maxDistance), m_prefix(prefix), m_table(TABLE_SIZE, 0)
+{
+    // Бит i маски символа c установлен, если i-й символ образца равен c
+    const int length = qMin(m_word.size(), int(MAX_LENGTH));
+    for (int i = 0; i < length; ++i) {
+        ushort c = m_word.at(i).unicode();
+        quint64 bit = quint64(1) << i;
+        if (c < TABLE_SIZE) {
+            m_table[c] |= bit;
+            continue;
+        }
+        bool found = false;
+        for (QPair<ushort, quint64> &entry : m_other) {
+            if (entry.first == c) {
+                entry.second |= bit;
+                found = true;
+            }
+        }
+        if (!found) {
+            m_other.append(qMakePair(c, bit));
+        }
+    }
+}
+
+int FuzzyMatcher::distanceFor(int length)
+{
+    if (length <= 3) {
+        return 0;
+    }
+    return length <= 6 ? 1 : 2;
+}
+
+quint64 FuzzyMatcher::mask(ushort c) const
+{
+    if (c < TABLE_SIZE) {
+        return m_table.at(c);
+    }
+    for (const QPair<ushort, quint64> &entry : m_other) {
+        if (entry.first == c) {
+            return entry.second;
+        }
+    }
+    return 0;
+}
+
+// Алгоритм Майерса в варианте Хюрё для расстояния Левенштейна: столбец матрицы
+// расстояний хранится разностями соседних клеток (маски Pv/Mv), score - нижняя клетка.
+// Без префикса нужна клетка после всего слова, с префиксом - минимум по столбцам
+int FuzzyMatcher::distance(const QString &word) const
+{
+    const int m = m_word.size();
+    const int n = word.size();
+    const int rejected = m_maxDistance + 1;
+    if (m > MAX_LENGTH) {
+        // Слишком длинный образец - только точное совпадение
+        bool equal = m_prefix ? word.startsWith(m_word) : word == m_word;
+        return equal ? 0 : rejected;
+    }
+    if (!m_prefix && qAbs(n - m) > m_maxDistance) {
+        return rejected;
+    }
+    if (m == 0) {
+        return m_prefix ? 0 : qMin(n, rejected);
+    }
+
+    const quint64 high = quint64(1) << (m - 1);
+    quint64 pv = ~quint64(0);
+    quint64 mv = 0;
+    int score = m;
+    int best = score;
+    for (int j = 0; j < n; ++j) {
+        quint64 eq = mask(word.at(j).unicode());
+        quint64 xv = eq | mv;
+        quint64 xh = (((eq & pv) + pv) ^ pv) | eq;
+        quint64 ph = mv | ~(xh | pv);
+        quint64 mh = pv & xh;
+        if (ph & high) {
+            ++score;
+        } else if (mh & high) {
+            --score;
+        }
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        if (m_prefix) {
+            best = qMin(best, score);
+            if (best <= m_maxDistance) {
+                return best;
+            }
+        } else if (score - (n - j - 1) > m_maxDistance) {
+            // Каждый следующий символ уменьшает расстояние не больше чем на единицу
+            return rejected;
+        }
+    }
+    int result = m_prefix ? best : score;
+    return qMin(result, rejected);
+}
+
+QVector<FuzzyMatcher> FuzzyTitleIndex::matchers(const QString &query)
+{
+    QVector<FuzzyMatcher> result;
+    QStringList words = FullTextIndex::tokenize(query);
+    for (int i = 0; i < words.size(); ++i) {
+        const QString &word = words.at(i);
+        result.append(FuzzyMatcher(word, FuzzyMatcher::distanceFor(word.size()), i == words.size() - 1));
+    }
+    return result;
+}
+
+bool FuzzyTitleIndex::matches(const QVector<FuzzyMatcher> &matchers, const QString &title)
+{
+    QStringList words = FullTextIndex::tokenize(title);
+    for (const FuzzyMatcher &matcher : matchers) {
+        bool found = false;
+        for (const QString &word : words) {
+            if (matcher.matches(word)) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FuzzyTitleIndex::insert(int slot, const QString &title)
+{
+    for (const QString &word : FullTextIndex::tokenize(title)) {
+        int id = m_wordIds.value(word, -1);
+        if (id < 0) {
+            id = m_words.size();
+            m_wordIds.insert(word, id);
+            m_words.append(word);
+            m_slots.append(QVector<int>());
+            int bucket = bucketOf(word);
+            if (m_byLength.size() <= bucket) {
+                m_byLength.resize(bucket + 1);
+                m_lengthPostings.resize(bucket + 1);
+            }
+            m_byLength[bucket].append(id);
+        }
+        QVector<int> &slots = m_slots[id];
+        // Новые задачи получают наибольший слот; повтор слова в названии - один слот
+        if (slots.isEmpty() || slots.last() < slot) {
+            slots.append(slot);
+        } else {
+            QVector<int>::iterator it = std::lower_bound(slots.begin(), slots.end(), slot);
+            if (*it == slot) {
+                continue;
+            }
+            slots.insert(it, slot);
+        }
+        ++m_lengthPostings[bucketOf(word)];
+    }
+}
+
+// Слово остается в словаре и с пустым списком - при поиске оно пропускается
+void FuzzyTitleIndex::remove(int slot, const QString &title)
+{
+    for (const QString &word : FullTextIndex::tokenize(title)) {
+        int id = m_wordIds.value(word, -1);
+        if (id < 0) {
+            continue;
+        }
+        QVector<int> &slots = m_slots[id];
+        QVector<int>::iterator it = std::lower_bound(slots.begin(), slots.end(), slot);
+        if (it != slots.end() && *it == slot) {
+            slots.erase(it);
+            --m_lengthPostings[bucketOf(word)];
+        }
+    }
+}
+
+void FuzzyTitleIndex::clear()
+{
+    m_wordIds.clear();
+    m_words.clear();
+    m_slots.clear();
+    m_byLength.clear();
+    m_lengthPostings.clear();
+}
+
+void FuzzyTitleIndex::remap(const QVector<int> &slots)
+{
+    QVector<QString> words;
+    QVector<QVector<int>> wordSlots;
+    m_wordIds.clear();
+    m_byLength.clear();
+    m_lengthPostings.clear();
+    for (int id = 0; id < m_words.size(); ++id) {
+        remapSlots(m_slots[id], slots);
+        if (m_slots.at(id).isEmpty()) {
+            continue;
+        }
+        const QString &word = m_words.at(id);
+        int bucket = bucketOf(word);
+        if (m_byLength.size() <= bucket) {
+            m_byLength.resize(bucket + 1);
+            m_lengthPostings.resize(bucket + 1);
+        }
+        m_byLength[bucket].append(words.size());
+        m_lengthPostings[bucket] += m_slots.at(id).size();
+        m_wordIds.insert(word, words.size());
+        words.append(word);
+        wordSlots.append(m_slots.at(id));
+    }
+    m_words = words;
+    m_slots = wordSlots;
+}
+
+void FuzzyTitleIndex::lengthRange(const FuzzyMatcher &matcher, int &minLength, int &maxLength)
+{
+    minLength = qMax(1, matcher.length() - matcher.maxDistance());
+    maxLength = matcher.isPrefix() ? MAX_BUCKET : qMin(int(MAX_BUCKET), matcher.length() + matcher.maxDistance());
+}
+
+// Задача попадает в результат, только если близкое слово есть для каждого слова
+// запроса, поэтому сумма по группам любого слова - оценка сверху (с повторами задач)
+int FuzzyTitleIndex::estimate(const QString &query) const
+{
+    QVector<FuzzyMatcher> patterns = matchers(query);
+    if (patterns.isEmpty()) {
+        return 0;
+    }
+    int result = std::numeric_limits<int>::max();
+    for (const FuzzyMatcher &matcher : patterns) {
+        int minLength;
+        int maxLength;
+        lengthRange(matcher, minLength, maxLength);
+        int total = 0;
+        for (int length = minLength; length <= maxLength && length < m_lengthPostings.size(); ++length) {
+            total += m_lengthPostings.at(length);
+        }
+        result = qMin(result, total);
+    }
+    return result;
+}
+
+SlotBitmap FuzzyTitleIndex::search(const QString &query) const
+{
+    QVector<FuzzyMatcher> patterns = matchers(query);
+    if (patterns.isEmpty()) {
+        return SlotBitmap();
+    }
+
+    SlotBitmap result;
+    bool first = true;
+    for (const FuzzyMatcher &matcher : patterns) {
+        int minLength;
+        int maxLength;
+        lengthRange(matcher, minLength, maxLength);
+        QVector<int> matched;
+        for (int length = minLength; length <= maxLength && length < m_byLength.size(); ++length) {
+            for (int id : m_byLength.at(length)) {
+                const QVector<int> &slots = m_slots.at(id);
+                if (!slots.isEmpty() && matcher.matches(m_words.at(id))) {
+                    matched += slots;
+                }
+            }
+        }
+        std::sort(matched.begin(), matched.end());
+        matched.erase(std::unique(matched.begin(), matched.end()), matched.end());
+
+        SlotBitmap wordSlots = SlotBitmap::fromSortedSlots(matched);
+        result = first ? wordSlots : (result & wordSlots);
+        first = false;
+        if (result.isEmpty()) {
+            break;
+        }
+    }
+    return result;
+}
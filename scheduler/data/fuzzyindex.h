@@ -0,0 +1,85 @@
+#ifndef FUZZYINDEX_H
+#define FUZZYINDEX_H
+
+#include "slotbitmap.h"
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include <QPair>
+
+// Сравнение слова запроса со словами словаря с ограниченным числом правок
+// (вставка, удаление, замена) - битово-параллельный алгоритм Майерса: одно слово
+// словаря проверяется за O(длина слова) операций над 64-битными масками.
+// В режиме префикса слово запроса сравнивается с лучшим префиксом слова словаря
+// (последнее слово еще дописывается). Слова - в свернутом регистре (FullTextIndex::tokenize)
+class FuzzyMatcher
+{
+public:
+    FuzzyMatcher(const QString &word, int maxDistance, bool prefix);
+
+    // Число правок (не больше maxDistance) или maxDistance + 1, если слово не подходит
+    // В режиме префикса проверка останавливается на первом подходящем префиксе
+    int distance(const QString &word) const;
+    bool matches(const QString &word) const { return distance(word) <= m_maxDistance; }
+
+    int length() const { return m_word.size(); }
+    int maxDistance() const { return m_maxDistance; }
+    bool isPrefix() const { return m_prefix; }
+
+    // Допустимое число правок для слова такой длины: короткие слова - без опечаток
+    static int distanceFor(int length);
+
+private:
+    static const int MAX_LENGTH = 64;     // длина образца ограничена разрядностью маски
+    static const int TABLE_SIZE = 0x500; // латиница и кириллица - прямой таблицей
+
+    quint64 mask(ushort c) const;
+
+    QString m_word;
+    int m_maxDistance;
+    bool m_prefix;
+    QVector<quint64> m_table;
+    QVector<QPair<ushort, quint64>> m_other;
+};
+
+// Словарь слов названий задач для нечеткого поиска
+// Для каждого различного слова хранится отсортированный список слотов задач,
+// слова сгруппированы по длине: проверяются только слова, длина которых
+// отличается от слова запроса не больше чем на допустимое число правок
+class FuzzyTitleIndex
+{
+public:
+    void insert(int slot, const QString &title);
+    void remove(int slot, const QString &title);
+    void clear();
+    // Перенумерация слотов после уплотнения хранилища; заодно из словаря
+    // выбрасываются слова, которых не осталось ни в одном названии
+    void remap(const QVector<int> &slots);
+
+    // Задачи, в названии которых для каждого слова запроса есть близкое слово
+    // Последнее слово запроса сравнивается как префикс
+    SlotBitmap search(const QString &query) const;
+    // Верхняя оценка размера search без сравнения слов: для каждого слова запроса -
+    // сумма длин списков слотов в группах подходящей длины, берется наименьшая
+    int estimate(const QString &query) const;
+
+    // Образцы для слов запроса (те же правила, что у search)
+    static QVector<FuzzyMatcher> matchers(const QString &query);
+    // Проверка одного названия без индекса
+    static bool matches(const QVector<FuzzyMatcher> &matchers, const QString &title);
+
+private:
+    static const int MAX_BUCKET = 64;
+
+    static int bucketOf(const QString &word) { return qMin(word.size(), int(MAX_BUCKET)); }
+    // Группы длин, в которых могут быть слова, близкие к образцу
+    static void lengthRange(const FuzzyMatcher &matcher, int &minLength, int &maxLength);
+
+    QHash<QString, int> m_wordIds;
+    QVector<QString> m_words;
+    QVector<QVector<int>> m_slots;   // по id слова
+    QVector<QVector<int>> m_byLength; // длина (не больше MAX_BUCKET) -> id слов
+    QVector<int> m_lengthPostings;    // длина -> сумма длин списков слотов ее слов
+};
+
+#endif // FUZZYINDEX_H
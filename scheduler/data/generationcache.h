@@ -0,0 +1,78 @@
+#ifndef GENERATIONCACHE_H
+#define GENERATIONCACHE_H
+
+#include <QList>
+#include <QtGlobal>
+
+// Ограниченный LRU-кеш результатов, привязанных к поколению данных
+// Запись действительна, только пока поколение репозитория совпадает с тем,
+// при котором она была вычислена. Размер кеша небольшой, поэтому поиск линейный
+template<typename Key, typename Value>
+class GenerationCache
+{
+public:
+    struct Stats {
+        int hits;
+        int misses;
+    };
+
+    explicit GenerationCache(int capacity = 16)
+        : m_capacity(capacity), m_hits(0), m_misses(0) {}
+
+    // Возвращает true и значение, если есть запись для ключа текущего поколения
+    bool lookup(const Key &key, quint64 generation, Value &value)
+    {
+        for (int i = 0; i < m_entries.size(); ++i) {
+            if (m_entries.at(i).key == key) {
+                if (m_entries.at(i).generation != generation) {
+                    m_entries.removeAt(i);
+                    break;
+                }
+                // Поднимаем запись в начало - она использовалась последней
+                m_entries.move(i, 0);
+                value = m_entries.first().value;
+                ++m_hits;
+                return true;
+            }
+        }
+        ++m_misses;
+        return false;
+    }
+
+    void insert(const Key &key, quint64 generation, const Value &value)
+    {
+        for (int i = 0; i < m_entries.size(); ++i) {
+            if (m_entries.at(i).key == key) {
+                m_entries.removeAt(i);
+                break;
+            }
+        }
+        Entry entry = { key, generation, value };
+        m_entries.prepend(entry);
+        while (m_entries.size() > m_capacity) {
+            m_entries.removeLast();
+        }
+    }
+
+    void clear() { m_entries.clear(); }
+
+    Stats stats() const
+    {
+        Stats result = { m_hits, m_misses };
+        return result;
+    }
+
+private:
+    struct Entry {
+        Key key;
+        quint64 generation;
+        Value value;
+    };
+
+    QList<Entry> m_entries;
+    int m_capacity;
+    int m_hits;
+    int m_misses;
+};
+
+#endif // GENERATIONCACHE_H
@@ -0,0 +1,131 @@
+#include "jsonarrayreader.h"
+#include <QIODevice>
+#include <QJsonDocument>
+#include <QJsonParseError>
+
+namespace {
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+}
+
+JsonArrayReader::JsonArrayReader(QIODevice *device)
+    : m_device(device), m_pos(0), m_started(false), m_finished(false), m_error(false)
+{
+}
+
+bool JsonArrayReader::readChunk()
+{
+    if (!m_device || m_device->atEnd()) {
+        return false;
+    }
+    m_chunk = m_device->read(CHUNK_SIZE);
+    m_pos = 0;
+    return !m_chunk.isEmpty();
+}
+
+bool JsonArrayReader::nextByte(char &c)
+{
+    if (m_pos >= m_chunk.size() && !readChunk()) {
+        return false;
+    }
+    c = m_chunk.at(m_pos++);
+    return true;
+}
+
+bool JsonArrayReader::next(QJsonObject &obj)
+{
+    if (m_error || m_finished) {
+        return false;
+    }
+
+    char c = 0;
+    // Пропускаем пробелы (и открывающую скобку перед первым элементом) и разделитель
+    for (;;) {
+        if (!nextByte(c)) {
+            m_error = true;
+            return false;
+        }
+        if (isSpace(c)) {
+            continue;
+        }
+        if (!m_started) {
+            if (c != '[') {
+                m_error = true;
+                return false;
+            }
+            m_started = true;
+            continue;
+        }
+        if (c == ',') {
+            continue;
+        }
+        if (c == ']') {
+            m_finished = true;
+            return false;
+        }
+        break;
+    }
+
+    if (c != '{' && c != '[' && c != '"') {
+        // Скаляр (число, true, false, null): дочитываем до разделителя и возвращаем его во вход
+        for (;;) {
+            if (!nextByte(c)) {
+                m_error = true;
+                return false;
+            }
+            if (c == ',' || c == ']' || isSpace(c)) {
+                --m_pos;
+                break;
+            }
+        }
+        obj = QJsonObject();
+        return true;
+    }
+
+    // Границу элемента ищем по глубине скобок вне строк
+    QByteArray element;
+    element.append(c);
+    int depth = c == '"' ? 0 : 1;
+    bool inString = c == '"';
+    bool escape = false;
+    while (depth > 0 || inString) {
+        if (!nextByte(c)) {
+            m_error = true;
+            return false;
+        }
+        element.append(c);
+        if (inString) {
+            if (escape) {
+                escape = false;
+            } else if (c == '\\') {
+                escape = true;
+            } else if (c == '"') {
+                inString = false;
+            }
+        } else if (c == '"') {
+            inString = true;
+        } else if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            --depth;
+        }
+    }
+
+    if (element.at(0) != '{') {
+        obj = QJsonObject();
+        return true;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(element, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        m_error = true;
+        return false;
+    }
+    obj = doc.object();
+    return true;
+}
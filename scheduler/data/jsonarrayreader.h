@@ -0,0 +1,37 @@
+#ifndef JSONARRAYREADER_H
+#define JSONARRAYREADER_H
+
+#include <QByteArray>
+#include <QJsonObject>
+
+class QIODevice;
+
+// Потоковое чтение JSON массива объектов из устройства
+// Файл читается кусками, каждый элемент верхнего уровня разбирается отдельно,
+// поэтому память не зависит от размера файла. Элемент, не являющийся объектом,
+// выдается пустым объектом (как QJsonValue::toObject)
+class JsonArrayReader
+{
+public:
+    explicit JsonArrayReader(QIODevice *device);
+
+    // Следующий элемент массива; false - конец массива или ошибка (см. hasError)
+    bool next(QJsonObject &obj);
+    bool hasError() const { return m_error; }
+
+private:
+    bool readChunk();
+    // Следующий байт входа; false - данные кончились
+    bool nextByte(char &c);
+
+    static const int CHUNK_SIZE = 64 * 1024;
+
+    QIODevice *m_device;
+    QByteArray m_chunk;
+    int m_pos;
+    bool m_started;  // открывающая скобка массива прочитана
+    bool m_finished; // закрывающая скобка прочитана
+    bool m_error;
+};
+
+#endif // JSONARRAYREADER_H
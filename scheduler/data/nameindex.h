@@ -0,0 +1,83 @@
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include "completionindex.h"
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QMultiHash>
+
+// Хеш-индекс сущностей (User, Project) по нормализованному имени
+// Нормализация: NFC, обрезка пробелов по краям и свернутый регистр,
+// поэтому "Иван Иванов" и " иван иванов" попадают в одну корзину.
+// Индекс помнит ключ каждого элемента, поэтому переименование через
+// update() корректно убирает старое имя. Заодно ведется индекс дополнения имен
+template<typename T>
+class NameIndex
+{
+public:
+    static QString normalize(const QString &name)
+    {
+        return name.normalized(QString::NormalizationForm_C).trimmed().toCaseFolded();
+    }
+
+    void insert(T *item)
+    {
+        QString key = normalize(item->getName());
+        m_byKey.insert(key, item);
+        m_keyOf.insert(item, key);
+        m_completion.insert(key, item->getName());
+    }
+
+    void remove(T *item)
+    {
+        typename QHash<T*, QString>::iterator it = m_keyOf.find(item);
+        if (it != m_keyOf.end()) {
+            m_byKey.remove(it.value(), item);
+            m_completion.remove(it.value());
+            m_keyOf.erase(it);
+        }
+    }
+
+    // Переиндексирует элемент после смены имени
+    void update(T *item)
+    {
+        remove(item);
+        insert(item);
+    }
+
+    // Сначала ищется точное совпадение имени, затем совпадение после нормализации
+    T* find(const QString &name) const
+    {
+        QString key = normalize(name);
+        T *normalizedMatch = nullptr;
+        typename QMultiHash<QString, T*>::const_iterator it = m_byKey.constFind(key);
+        for (; it != m_byKey.constEnd() && it.key() == key; ++it) {
+            if (it.value()->getName() == name) {
+                return it.value();
+            }
+            normalizedMatch = it.value();
+        }
+        return normalizedMatch;
+    }
+
+    // Имена, начинающиеся с prefix (после нормализации); частота - число элементов с именем
+    QStringList complete(const QString &prefix, int limit) const
+    {
+        return m_completion.complete(normalize(prefix), limit);
+    }
+
+    void clear()
+    {
+        m_byKey.clear();
+        m_keyOf.clear();
+        m_completion.clear();
+    }
+
+private:
+    QMultiHash<QString, T*> m_byKey;
+    QHash<T*, QString> m_keyOf;
+    CompletionIndex m_completion;
+};
+
+#endif // NAMEINDEX_H
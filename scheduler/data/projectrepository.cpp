@@ -12,40 +12,45 @@ void ProjectRepository::add(Project *project)
         if (project->getId() < 0) {
             project->setId(m_nextProjectId++);
         }
-        m_projects.append(project);
+        m_projects.insert(project);
+        m_byName.insert(project);
     }
 }
 
 void ProjectRepository::remove(Project *project)
 {
-    m_projects.removeAll(project);
+    if (m_projects.take(project) >= 0) {
+        m_byName.remove(project);
+        if (m_projects.isSparse()) {
+            m_projects.compact();
+        }
+    }
 }
 
 Project* ProjectRepository::findById(int id) const
 {
-    for (Project *project : m_projects) {
-        if (project->getId() == id) {
-            return project;
-        }
-    }
-    return nullptr;
+    return m_projects.findById(id);
 }
 
 void ProjectRepository::clear()
 {
     m_projects.clear();
+    m_byName.clear();
     m_nextProjectId = 1;
 }
 
 Project* ProjectRepository::findByName(const QString &name) const
 {
-    for (Project *project : m_projects) {
-        if (project->getName() == name) {
-            return project;
-        }
-    }
-    return nullptr;
+    return m_byName.find(name);
 }
 
-
-
+void ProjectRepository::rename(Project *project, const QString &name)
+{
+    if (!project) {
+        return;
+    }
+    project->setName(name);
+    if (m_projects.contains(project)) {
+        m_byName.update(project);
+    }
+}
@@ -2,6 +2,8 @@
 #define PROJECTREPOSITORY_H
 
 #include "repositories.h"
+#include "slotstore.h"
+#include "nameindex.h"
 #include <QObject>
 
 class ProjectRepository : public QObject, public IProjectRepository
@@ -14,18 +16,21 @@ public:
     // IRepository interface
     void add(Project *project) override;
     void remove(Project *project) override;
-    QList<Project*> getAll() const override { return m_projects; }
+    QList<Project*> getAll() const override { return m_projects.items(); }
     Project* findById(int id) const override;
     void clear() override;
     
     // IProjectRepository interface
     Project* findByName(const QString &name) const override;
+    void rename(Project *project, const QString &name) override;
+    QStringList completeName(const QString &prefix, int limit) const override { return m_byName.complete(prefix, limit); }
     
     int getNextId() { return m_nextProjectId++; }
     void setNextId(int id) { m_nextProjectId = id; }
 
 private:
-    QList<Project*> m_projects;
+    SlotStore<Project> m_projects;
+    NameIndex<Project> m_byName;
     int m_nextProjectId;
 };
 
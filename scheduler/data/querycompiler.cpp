@@ -0,0 +1,309 @@
+#include "querycompiler.h"
+#include "../models/task.h"
+#include "../models/user.h"
+#include "../models/project.h"
+#include <QDateTime>
+#include <QTime>
+#include <QHash>
+
+namespace {
+
+enum Field { OwnerField, ProjectField, PriorityField, DueField, TitleField, StatusField, UnknownField };
+
+// Имена полей и значений сравниваются без учета регистра по словарям,
+// которые строятся один раз - разбор на каждое нажатие клавиши не аллоцирует их заново
+Field fieldByName(const QString &name)
+{
+    static const QHash<QString, Field> names = {
+        { "owner", OwnerField }, { "user", OwnerField }, { QString::fromUtf8("владелец"), OwnerField },
+        { "project", ProjectField }, { QString::fromUtf8("проект"), ProjectField },
+        { "priority", PriorityField }, { QString::fromUtf8("приоритет"), PriorityField },
+        { "due", DueField }, { "deadline", DueField }, { QString::fromUtf8("дедлайн"), DueField },
+        { "title", TitleField }, { QString::fromUtf8("название"), TitleField },
+        { "is", StatusField }, { QString::fromUtf8("статус"), StatusField }
+    };
+    return name.isEmpty() ? UnknownField : names.value(name.toLower(), UnknownField);
+}
+
+// Значение is: - true для завершенных, false для открытых задач
+bool parseStatus(const QString &value, bool &completed)
+{
+    static const QHash<QString, bool> names = {
+        { "done", true }, { QString::fromUtf8("завершена"), true },
+        { "open", false }, { QString::fromUtf8("открыта"), false }
+    };
+    QHash<QString, bool>::const_iterator it = names.constFind(value.toLower());
+    if (it == names.constEnd()) {
+        return false;
+    }
+    completed = it.value();
+    return true;
+}
+
+QDateTime dayStart(const QDate &day)
+{
+    return QDateTime(day, QTime(0, 0));
+}
+
+QueryPredicatePtr maybeNegate(const QueryPredicatePtr &predicate, bool negated)
+{
+    return negated ? QueryPredicate::negate(predicate) : predicate;
+}
+
+}
+
+bool CompiledQuery::matches(Task *task) const
+{
+    for (const QueryPredicatePtr &predicate : predicates) {
+        if (!predicate->matches(task)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QueryCompiler::QueryCompiler(const IUserRepository *users, const IProjectRepository *projects, bool fuzzy)
+    : m_users(users), m_projects(projects), m_fuzzy(fuzzy)
+{
+}
+
+QueryPredicatePtr QueryCompiler::titlePredicate(const QString &text) const
+{
+    return m_fuzzy ? QueryPredicate::fuzzyTitle(text) : QueryPredicate::title(text);
+}
+
+CompiledQuery QueryCompiler::compile(const QString &text, const QDate &today) const
+{
+    CompiledQuery query;
+    QDate date = today.isValid() ? today : QDate::currentDate();
+    bool structured = false;
+    const int n = text.size();
+    int pos = 0;
+
+    while (query.error.isEmpty()) {
+        while (pos < n && text.at(pos).isSpace()) {
+            ++pos;
+        }
+        if (pos >= n) {
+            break;
+        }
+
+        // Отрицание - "!" или "-" вплотную к полю с оператором или к фразе в кавычках.
+        // Перед обычным словом знак остается частью слова
+        int termStart = pos;
+        bool negated = false;
+        QChar first = text.at(pos);
+        if ((first == QLatin1Char('!') || first == QLatin1Char('-')) &&
+            pos + 1 < n && !text.at(pos + 1).isSpace()) {
+            negated = true;
+            ++pos;
+        }
+
+        if (text.at(pos) == QLatin1Char('"')) {
+            structured = true;
+            QString phrase = readValue(text, pos);
+            if (!phrase.isEmpty()) {
+                query.predicates.append(maybeNegate(QueryPredicate::title(phrase), negated));
+            }
+            continue;
+        }
+
+        int start = pos;
+        while (pos < n && text.at(pos).isLetter()) {
+            ++pos;
+        }
+        QString name = text.mid(start, pos - start);
+        if (fieldByName(name) != UnknownField) {
+            Operator op = readOperator(text, pos);
+            if (op != NoOperator) {
+                structured = true;
+                compileField(name, op, readValue(text, pos), negated, date, query.predicates, query.error);
+                continue;
+            }
+        }
+
+        // Обычное слово (или неизвестное поле) вместе со знаком - подстрока названия
+        pos = termStart;
+        query.predicates.append(titlePredicate(readValue(text, pos)));
+    }
+
+    if (!query.error.isEmpty()) {
+        query.predicates.clear();
+        query.predicates.append(QueryPredicate::none(query.error));
+    } else if (!structured) {
+        // Обычный поиск: вся строка как одна подстрока, включая пробелы
+        query.plainText = true;
+        query.predicates.clear();
+        QString plain = text.trimmed();
+        if (!plain.isEmpty()) {
+            query.predicates.append(titlePredicate(plain));
+        }
+    }
+    return query;
+}
+
+void QueryCompiler::compileField(const QString &name, Operator op, const QString &value, bool negated,
+                                 const QDate &today, QList<QueryPredicatePtr> &predicates, QString &error) const
+{
+    if (value.isEmpty()) {
+        error = QString("Не указано значение для \"%1\"").arg(name);
+        return;
+    }
+    Field field = fieldByName(name);
+    bool ordered = op != Equal && op != NotEqual;
+    if (ordered && field != PriorityField && field != DueField) {
+        error = QString("Поле \"%1\" поддерживает только операторы : = !=").arg(name);
+        return;
+    }
+    if (op == NotEqual) {
+        negated = !negated;
+    }
+
+    switch (field) {
+    case OwnerField: {
+        User *user = m_users ? m_users->findByName(value) : nullptr;
+        QueryPredicatePtr predicate = user ? QueryPredicate::owner(user)
+                                           : QueryPredicate::none(QString("нет пользователя \"%1\"").arg(value));
+        predicates.append(maybeNegate(predicate, negated));
+        return;
+    }
+    case ProjectField: {
+        Project *project = m_projects ? m_projects->findByName(value) : nullptr;
+        QueryPredicatePtr predicate = project ? QueryPredicate::project(project)
+                                              : QueryPredicate::none(QString("нет проекта \"%1\"").arg(value));
+        predicates.append(maybeNegate(predicate, negated));
+        return;
+    }
+    case TitleField:
+        predicates.append(maybeNegate(titlePredicate(value), negated));
+        return;
+    case StatusField: {
+        bool completed = false;
+        if (!parseStatus(value, completed)) {
+            error = QString("Неизвестный статус \"%1\" (ожидается done или open)").arg(value);
+            return;
+        }
+        predicates.append(QueryPredicate::completed(completed != negated));
+        return;
+    }
+    case PriorityField: {
+        int priority = 0;
+        if (!parsePriority(value, priority)) {
+            error = QString("Неизвестный приоритет \"%1\"").arg(value);
+            return;
+        }
+        int min = int(Priority::Low);
+        int max = int(Priority::High);
+        switch (op) {
+        case Less: max = priority - 1; break;
+        case LessEqual: max = priority; break;
+        case Greater: min = priority + 1; break;
+        case GreaterEqual: min = priority; break;
+        default: min = max = priority;
+        }
+        QueryPredicatePtr predicate = min <= max
+            ? QueryPredicate::priorityRange(static_cast<Priority>(min), static_cast<Priority>(max))
+            : QueryPredicate::none(QString("пустой диапазон приоритетов"));
+        predicates.append(maybeNegate(predicate, negated));
+        return;
+    }
+    case DueField: {
+        QDate day = parseDate(value, today);
+        if (!day.isValid()) {
+            error = QString("Неверная дата \"%1\" (ожидается гггг-ММ-дд)").arg(value);
+            return;
+        }
+        QueryPredicatePtr predicate;
+        switch (op) {
+        case Less: predicate = QueryPredicate::deadlineRange(QDateTime(), dayStart(day)); break;
+        case LessEqual: predicate = QueryPredicate::deadlineRange(QDateTime(), dayStart(day.addDays(1))); break;
+        case Greater: predicate = QueryPredicate::deadlineRange(dayStart(day.addDays(1)), QDateTime()); break;
+        case GreaterEqual: predicate = QueryPredicate::deadlineRange(dayStart(day), QDateTime()); break;
+        default: predicate = QueryPredicate::deadlineDay(day);
+        }
+        predicates.append(maybeNegate(predicate, negated));
+        return;
+    }
+    default:
+        error = QString("Неизвестное поле \"%1\"").arg(name);
+        return;
+    }
+}
+
+QueryCompiler::Operator QueryCompiler::readOperator(const QString &text, int &pos)
+{
+    if (pos >= text.size()) {
+        return NoOperator;
+    }
+    QChar c = text.at(pos);
+    bool equalsNext = pos + 1 < text.size() && text.at(pos + 1) == QLatin1Char('=');
+    if (c == QLatin1Char(':') || c == QLatin1Char('=')) {
+        ++pos;
+        return Equal;
+    }
+    if (c == QLatin1Char('!') && equalsNext) {
+        pos += 2;
+        return NotEqual;
+    }
+    if (c == QLatin1Char('<')) {
+        pos += equalsNext ? 2 : 1;
+        return equalsNext ? LessEqual : Less;
+    }
+    if (c == QLatin1Char('>')) {
+        pos += equalsNext ? 2 : 1;
+        return equalsNext ? GreaterEqual : Greater;
+    }
+    return NoOperator;
+}
+
+// Значение в кавычках (до закрывающей кавычки или конца строки - пока ее дописывают)
+// либо слово до пробела
+QString QueryCompiler::readValue(const QString &text, int &pos)
+{
+    const int n = text.size();
+    if (pos < n && text.at(pos) == QLatin1Char('"')) {
+        int start = ++pos;
+        while (pos < n && text.at(pos) != QLatin1Char('"')) {
+            ++pos;
+        }
+        QString value = text.mid(start, pos - start);
+        if (pos < n) {
+            ++pos;
+        }
+        return value;
+    }
+    int start = pos;
+    while (pos < n && !text.at(pos).isSpace()) {
+        ++pos;
+    }
+    return text.mid(start, pos - start);
+}
+
+bool QueryCompiler::parsePriority(const QString &value, int &priority)
+{
+    static const QHash<QString, Priority> names = {
+        { "low", Priority::Low }, { QString::fromUtf8("низкий"), Priority::Low }, { "0", Priority::Low },
+        { "medium", Priority::Medium }, { QString::fromUtf8("средний"), Priority::Medium }, { "1", Priority::Medium },
+        { "high", Priority::High }, { QString::fromUtf8("высокий"), Priority::High }, { "2", Priority::High }
+    };
+    QHash<QString, Priority>::const_iterator it = names.constFind(value.toLower());
+    if (it == names.constEnd()) {
+        return false;
+    }
+    priority = int(it.value());
+    return true;
+}
+
+QDate QueryCompiler::parseDate(const QString &value, const QDate &today)
+{
+    static const QHash<QString, int> relative = {
+        { "today", 0 }, { QString::fromUtf8("сегодня"), 0 },
+        { "tomorrow", 1 }, { QString::fromUtf8("завтра"), 1 },
+        { "yesterday", -1 }, { QString::fromUtf8("вчера"), -1 }
+    };
+    QHash<QString, int>::const_iterator it = relative.constFind(value.toLower());
+    if (it != relative.constEnd()) {
+        return today.addDays(it.value());
+    }
+    return QDate::fromString(value, Qt::ISODate);
+}
@@ -0,0 +1,58 @@
+#ifndef QUERYCOMPILER_H
+#define QUERYCOMPILER_H
+
+#include "repositories.h"
+#include "queryplanner.h"
+#include <QList>
+#include <QDate>
+#include <QString>
+
+// Скомпилированный текстовый запрос - конъюнкция предикатов планировщика
+struct CompiledQuery {
+    QList<QueryPredicatePtr> predicates;
+    QString error; // пусто, если запрос разобран без ошибок
+    bool plainText = false; // строка без полей и операторов - одна подстрока названия
+
+    bool isValid() const { return error.isEmpty(); }
+    bool matches(Task *task) const;
+};
+
+// Компилятор языка запросов строки поиска
+// Термы разделяются пробелами и должны выполняться все:
+//   owner:"Иван Иванов"     владелец (также user:, владелец:)
+//   project:Разработка      проект (также проект:)
+//   priority>=medium        приоритет: low|medium|high, низкий|средний|высокий, 0..2
+//   due<2026-11-01          дедлайн: yyyy-MM-dd, today|tomorrow|yesterday, сегодня|завтра|вчера
+//   is:done, is:open        завершена / открыта (также статус:завершена, статус:открыта)
+//   title:отчет, "фраза"    название содержит, как и просто слово
+// Операторы : = != < <= > >=; префикс ! или - отрицает поле или фразу в кавычках
+// (!is:done - незавершенные, -"черновик" - без фразы в названии)
+// Обычные слова, в том числе "done" и "-слово", - подстроки названия.
+// Строка без полей и кавычек целиком ищется в названии, как раньше
+// В нечетком режиме слова и обычный текст ищутся с опечатками (фразы в кавычках - точно)
+// Разбор - один проход по строке без регулярных выражений, имена ищутся по хеш-индексам
+class QueryCompiler
+{
+public:
+    QueryCompiler(const IUserRepository *users, const IProjectRepository *projects, bool fuzzy = false);
+
+    // today - дата для относительных дат (по умолчанию текущая)
+    CompiledQuery compile(const QString &text, const QDate &today = QDate()) const;
+
+private:
+    enum Operator { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual, NoOperator };
+
+    void compileField(const QString &field, Operator op, const QString &value, bool negated,
+                      const QDate &today, QList<QueryPredicatePtr> &predicates, QString &error) const;
+    QueryPredicatePtr titlePredicate(const QString &text) const;
+    static Operator readOperator(const QString &text, int &pos);
+    static QString readValue(const QString &text, int &pos);
+    static bool parsePriority(const QString &value, int &priority);
+    static QDate parseDate(const QString &value, const QDate &today);
+
+    const IUserRepository *m_users;
+    const IProjectRepository *m_projects;
+    bool m_fuzzy;
+};
+
+#endif // QUERYCOMPILER_H
@@ -0,0 +1,415 @@
+#include "queryplanner.h"
+#include "casefoldsearch.h"
+#include "fuzzyindex.h"
+#include "../models/task.h"
+#include "../models/user.h"
+#include "../models/project.h"
+#include <QStringList>
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+
+namespace {
+
+class TitlePredicate : public QueryPredicate
+{
+public:
+    explicit TitlePredicate(const QString &keyword) : m_keyword(keyword) {}
+    QString describe() const override { return QString("название содержит \"%1\"").arg(m_keyword); }
+    int estimate(const ITaskRepository *repo) const override { return repo->estimateTitleMatches(m_keyword); }
+    SlotBitmap fetch(const ITaskRepository *repo) const override { return repo->slotsByTitle(m_keyword); }
+    bool matches(Task *task) const override { return CaseFoldSearch::containsFolded(task->getFoldedTitle(), m_keyword); }
+    int residualCost() const override { return 8; }
+
+private:
+    QString m_keyword;
+};
+
+class FuzzyTitlePredicate : public QueryPredicate
+{
+public:
+    explicit FuzzyTitlePredicate(const QString &text)
+        : m_text(text), m_matchers(FuzzyTitleIndex::matchers(text)) {}
+    QString describe() const override { return QString("название похоже на \"%1\"").arg(m_text); }
+    int estimate(const ITaskRepository *repo) const override { return repo->estimateFuzzyTitleMatches(m_text); }
+    SlotBitmap fetch(const ITaskRepository *repo) const override { return repo->slotsByFuzzyTitle(m_text); }
+    bool matches(Task *task) const override { return FuzzyTitleIndex::matches(m_matchers, task->getTitle()); }
+    int residualCost() const override { return 16; }
+
+private:
+    QString m_text;
+    QVector<FuzzyMatcher> m_matchers;
+};
+
+// Диапазон приоритетов [min, max]; равенство - диапазон из одного значения
+class PriorityPredicate : public QueryPredicate
+{
+public:
+    PriorityPredicate(Priority min, Priority max) : m_min(int(min)), m_max(int(max)) {}
+    QString describe() const override
+    {
+        if (m_min == m_max) {
+            return QString("приоритет = %1").arg(Task::priorityToString(static_cast<Priority>(m_min)));
+        }
+        return QString("приоритет %1..%2").arg(Task::priorityToString(static_cast<Priority>(m_min)),
+                                                Task::priorityToString(static_cast<Priority>(m_max)));
+    }
+    int estimate(const ITaskRepository *repo) const override
+    {
+        int count = 0;
+        for (int p = m_min; p <= m_max; ++p) {
+            count += repo->slotsByPriority(static_cast<Priority>(p)).count();
+        }
+        return count;
+    }
+    SlotBitmap fetch(const ITaskRepository *repo) const override
+    {
+        SlotBitmap result;
+        for (int p = m_min; p <= m_max; ++p) {
+            result = result | repo->slotsByPriority(static_cast<Priority>(p));
+        }
+        return result;
+    }
+    bool matches(Task *task) const override
+    {
+        int priority = int(task->getPriority());
+        return priority >= m_min && priority <= m_max;
+    }
+
+private:
+    int m_min;
+    int m_max;
+};
+
+class ProjectPredicate : public QueryPredicate
+{
+public:
+    explicit ProjectPredicate(Project *project) : m_project(project) {}
+    QString describe() const override { return QString("проект = %1").arg(m_project ? m_project->getName() : QString()); }
+    int estimate(const ITaskRepository *repo) const override { return repo->slotsByProject(m_project).count(); }
+    SlotBitmap fetch(const ITaskRepository *repo) const override { return repo->slotsByProject(m_project); }
+    bool matches(Task *task) const override { return task->getProject() == m_project; }
+
+private:
+    Project *m_project;
+};
+
+class OwnerPredicate : public QueryPredicate
+{
+public:
+    explicit OwnerPredicate(User *owner) : m_owner(owner) {}
+    QString describe() const override { return QString("владелец = %1").arg(m_owner ? m_owner->getName() : QString()); }
+    int estimate(const ITaskRepository *repo) const override { return repo->slotsByOwner(m_owner).count(); }
+    SlotBitmap fetch(const ITaskRepository *repo) const override { return repo->slotsByOwner(m_owner); }
+    bool matches(Task *task) const override { return task->getOwner() == m_owner; }
+
+private:
+    User *m_owner;
+};
+
+class DeadlineDayPredicate : public QueryPredicate
+{
+public:
+    explicit DeadlineDayPredicate(const QDate &day) : m_day(day) {}
+    QString describe() const override { return QString("дедлайн %1").arg(m_day.toString("dd.MM.yyyy")); }
+    int estimate(const ITaskRepository *repo) const override { return repo->estimateDeadlineDay(m_day); }
+    SlotBitmap fetch(const ITaskRepository *repo) const override { return repo->slotsByDeadlineDay(m_day); }
+    bool matches(Task *task) const override { return task->getDeadline().date() == m_day; }
+    int residualCost() const override { return 2; }
+
+private:
+    QDate m_day;
+};
+
+class DeadlineRangePredicate : public QueryPredicate
+{
+public:
+    DeadlineRangePredicate(const QDateTime &from, const QDateTime &to) : m_from(from), m_to(to) {}
+    QString describe() const override
+    {
+        QString from = m_from.isValid() ? m_from.toString("dd.MM.yyyy HH:mm") : QString("...");
+        QString to = m_to.isValid() ? m_to.toString("dd.MM.yyyy HH:mm") : QString("...");
+        return QString("дедлайн в [%1, %2)").arg(from, to);
+    }
+    int estimate(const ITaskRepository *repo) const override { return repo->estimateDeadlineRange(m_from, m_to); }
+    SlotBitmap fetch(const ITaskRepository *repo) const override { return repo->slotsByDeadlineRange(m_from, m_to); }
+    bool matches(Task *task) const override
+    {
+        const QDateTime &deadline = task->getDeadline();
+        return deadline.isValid() &&
+               (!m_from.isValid() || deadline >= m_from) &&
+               (!m_to.isValid() || deadline < m_to);
+    }
+    int residualCost() const override { return 2; }
+
+private:
+    QDateTime m_from;
+    QDateTime m_to;
+};
+
+class CompletedPredicate : public QueryPredicate
+{
+public:
+    explicit CompletedPredicate(bool completed) : m_completed(completed) {}
+    QString describe() const override { return m_completed ? QString("завершена") : QString("не завершена"); }
+    int estimate(const ITaskRepository *repo) const override { return repo->slotsByCompleted(m_completed).count(); }
+    SlotBitmap fetch(const ITaskRepository *repo) const override { return repo->slotsByCompleted(m_completed); }
+    bool matches(Task *task) const override { return task->isCompleted() == m_completed; }
+
+private:
+    bool m_completed;
+};
+
+// Отрицание: через индекс - разность со всеми задачами
+class NotPredicate : public QueryPredicate
+{
+public:
+    explicit NotPredicate(const QueryPredicatePtr &predicate) : m_predicate(predicate) {}
+    QString describe() const override { return QString("НЕ (%1)").arg(m_predicate->describe()); }
+    int estimate(const ITaskRepository *repo) const override
+    {
+        return qMax(0, repo->allSlots().count() - m_predicate->estimate(repo));
+    }
+    SlotBitmap fetch(const ITaskRepository *repo) const override
+    {
+        return repo->allSlots().andNot(m_predicate->fetch(repo));
+    }
+    bool matches(Task *task) const override { return !m_predicate->matches(task); }
+    int residualCost() const override { return m_predicate->residualCost(); }
+
+private:
+    QueryPredicatePtr m_predicate;
+};
+
+class NonePredicate : public QueryPredicate
+{
+public:
+    explicit NonePredicate(const QString &reason) : m_reason(reason) {}
+    QString describe() const override { return QString("пусто: %1").arg(m_reason); }
+    int estimate(const ITaskRepository *) const override { return 0; }
+    SlotBitmap fetch(const ITaskRepository *) const override { return SlotBitmap(); }
+    bool matches(Task *) const override { return false; }
+
+private:
+    QString m_reason;
+};
+
+QString modeName(QueryPlanner::StepMode mode)
+{
+    switch (mode) {
+    case QueryPlanner::FullScan: return "SCAN";
+    case QueryPlanner::IndexAccess: return "ACCESS";
+    case QueryPlanner::IndexIntersect: return "INTERSECT";
+    case QueryPlanner::Residual: return "RESIDUAL";
+    default: return "?";
+    }
+}
+
+}
+
+QueryPredicatePtr QueryPredicate::title(const QString &keyword)
+{
+    return QueryPredicatePtr(new TitlePredicate(keyword));
+}
+
+QueryPredicatePtr QueryPredicate::fuzzyTitle(const QString &text)
+{
+    return QueryPredicatePtr(new FuzzyTitlePredicate(text));
+}
+
+QueryPredicatePtr QueryPredicate::priorityRange(Priority min, Priority max)
+{
+    return QueryPredicatePtr(new PriorityPredicate(min, max));
+}
+
+QueryPredicatePtr QueryPredicate::project(Project *project)
+{
+    return QueryPredicatePtr(new ProjectPredicate(project));
+}
+
+QueryPredicatePtr QueryPredicate::owner(User *owner)
+{
+    return QueryPredicatePtr(new OwnerPredicate(owner));
+}
+
+QueryPredicatePtr QueryPredicate::deadlineDay(const QDate &day)
+{
+    return QueryPredicatePtr(new DeadlineDayPredicate(day));
+}
+
+QueryPredicatePtr QueryPredicate::deadlineRange(const QDateTime &from, const QDateTime &to)
+{
+    return QueryPredicatePtr(new DeadlineRangePredicate(from, to));
+}
+
+QueryPredicatePtr QueryPredicate::completed(bool completed)
+{
+    return QueryPredicatePtr(new CompletedPredicate(completed));
+}
+
+QueryPredicatePtr QueryPredicate::negate(const QueryPredicatePtr &predicate)
+{
+    return QueryPredicatePtr(new NotPredicate(predicate));
+}
+
+QueryPredicatePtr QueryPredicate::none(const QString &reason)
+{
+    return QueryPredicatePtr(new NonePredicate(reason));
+}
+
+QueryPlanner::QueryPlanner(const ITaskRepository *repo)
+    : m_repository(repo), m_total(0), m_estimatedResult(0), m_parallelThreshold(0)
+{
+}
+
+// Строит план: предикаты сортируются по оценке, самый селективный - путь доступа
+// Для остальных сравнивается стоимость пересечения с картой индекса (пропорциональна
+// размеру карты) и прямой проверки ожидаемого числа кандидатов
+void QueryPlanner::build(const TaskService::FilterOptions &filterOpts,
+                         const QList<QueryPredicatePtr> &extra)
+{
+    m_predicates.clear();
+    m_steps.clear();
+    m_total = m_repository ? m_repository->allSlots().count() : 0;
+    m_estimatedResult = m_total;
+    if (!m_repository) {
+        return;
+    }
+
+    // Нечеткий поиск по searchText приходит в extra (см. TaskService::compiledQuery)
+    if (!filterOpts.searchText.isEmpty() && !filterOpts.fuzzySearch) {
+        m_predicates.append(QueryPredicate::title(filterOpts.searchText));
+    }
+    if (filterOpts.priorityFilterEnabled) {
+        m_predicates.append(QueryPredicate::priorityRange(filterOpts.priorityFilter, filterOpts.priorityFilter));
+    }
+    if (filterOpts.projectFilter) {
+        m_predicates.append(QueryPredicate::project(filterOpts.projectFilter));
+    }
+    if (filterOpts.userFilter) {
+        m_predicates.append(QueryPredicate::owner(filterOpts.userFilter));
+    }
+    if (filterOpts.dateFilterEnabled && filterOpts.dateFilter.isValid()) {
+        m_predicates.append(QueryPredicate::deadlineDay(filterOpts.dateFilter.date()));
+    }
+    if (!filterOpts.showCompleted) {
+        m_predicates.append(QueryPredicate::completed(false));
+    }
+    m_predicates.append(extra);
+
+    if (m_predicates.isEmpty()) {
+        Step step = { nullptr, m_total, FullScan };
+        m_steps.append(step);
+        return;
+    }
+
+    for (const QueryPredicatePtr &predicate : m_predicates) {
+        Step step = { predicate.data(), predicate->estimate(m_repository), IndexIntersect };
+        m_steps.append(step);
+    }
+    std::stable_sort(m_steps.begin(), m_steps.end(), [](const Step &a, const Step &b) {
+        return a.estimate < b.estimate;
+    });
+
+    m_steps[0].mode = IndexAccess;
+    double candidates = m_steps.at(0).estimate;
+    for (int i = 1; i < m_steps.size(); ++i) {
+        Step &step = m_steps[i];
+        double residualCost = candidates * step.predicate->residualCost();
+        step.mode = residualCost < step.estimate ? Residual : IndexIntersect;
+        // Оценка кандидатов в предположении независимости предикатов
+        if (m_total > 0) {
+            candidates *= double(step.estimate) / m_total;
+        }
+    }
+    m_estimatedResult = int(candidates + 0.5);
+}
+
+QList<Task*> QueryPlanner::execute() const
+{
+    if (!m_repository || m_steps.isEmpty()) {
+        return QList<Task*>();
+    }
+    if (m_steps.at(0).mode == FullScan) {
+        return m_repository->getAll();
+    }
+
+    // Сначала все индексные шаги над битовыми картами, затем материализация
+    SlotBitmap candidates = m_steps.at(0).predicate->fetch(m_repository);
+    for (int i = 1; i < m_steps.size() && !candidates.isEmpty(); ++i) {
+        if (m_steps.at(i).mode == IndexIntersect) {
+            candidates &= m_steps.at(i).predicate->fetch(m_repository);
+        }
+    }
+
+    QList<Task*> tasks = m_repository->materialize(candidates);
+
+    QList<const QueryPredicate*> residuals;
+    for (const Step &step : m_steps) {
+        if (step.mode == Residual) {
+            residuals.append(step.predicate);
+        }
+    }
+    if (residuals.isEmpty()) {
+        return tasks;
+    }
+
+    if (m_parallelThreshold <= 0 || tasks.size() < m_parallelThreshold) {
+        return applyResiduals(tasks, 0, tasks.size(), residuals);
+    }
+
+    // Предикаты только читают поля задач, поэтому куски проверяются независимо;
+    // результаты склеиваются в исходном порядке кусков
+    const int chunkCount = qMax(1, QThread::idealThreadCount());
+    const int chunkSize = (tasks.size() + chunkCount - 1) / chunkCount;
+    QList<QFuture<QList<Task*>>> futures;
+    for (int begin = 0; begin < tasks.size(); begin += chunkSize) {
+        int end = qMin(begin + chunkSize, tasks.size());
+        futures.append(QtConcurrent::run([tasks, begin, end, residuals]() {
+            return applyResiduals(tasks, begin, end, residuals);
+        }));
+    }
+    QList<Task*> result;
+    for (QFuture<QList<Task*>> &future : futures) {
+        result.append(future.result());
+    }
+    return result;
+}
+
+QList<Task*> QueryPlanner::applyResiduals(const QList<Task*> &tasks, int begin, int end,
+                                          const QList<const QueryPredicate*> &residuals)
+{
+    QList<Task*> result;
+    for (int i = begin; i < end; ++i) {
+        Task *task = tasks.at(i);
+        bool ok = true;
+        for (const QueryPredicate *predicate : residuals) {
+            if (!predicate->matches(task)) {
+                ok = false;
+                break;
+            }
+        }
+        if (ok) {
+            result.append(task);
+        }
+    }
+    return result;
+}
+
+QString QueryPlanner::explain() const
+{
+    QStringList lines;
+    lines.append(QString("Всего задач: %1").arg(m_total));
+    for (int i = 0; i < m_steps.size(); ++i) {
+        const Step &step = m_steps.at(i);
+        QString what = step.predicate ? step.predicate->describe() : QString("все задачи");
+        lines.append(QString("%1. %2 %3 (~%4)")
+                     .arg(i + 1)
+                     .arg(modeName(step.mode), -9)
+                     .arg(what)
+                     .arg(step.estimate));
+    }
+    lines.append(QString("Оценка результата: ~%1").arg(m_estimatedResult));
+    return lines.join("\n");
+}
@@ -0,0 +1,98 @@
+#ifndef QUERYPLANNER_H
+#define QUERYPLANNER_H
+
+#include "repositories.h"
+#include "taskservice.h"
+#include <QList>
+#include <QVector>
+#include <QString>
+#include <QSharedPointer>
+
+class QueryPredicate;
+// Предикаты неизменяемы и не зависят от репозитория, поэтому один экземпляр
+// разделяется между планами (например, скомпилированный текстовый запрос из кеша)
+typedef QSharedPointer<const QueryPredicate> QueryPredicatePtr;
+
+// Предикат запроса для планировщика
+// Умеет оценить число подходящих задач по статистике индексов,
+// получить их из индекса битовой картой и проверить отдельную задачу
+class QueryPredicate
+{
+public:
+    virtual ~QueryPredicate() = default;
+    virtual QString describe() const = 0;
+    virtual int estimate(const ITaskRepository *repo) const = 0;
+    virtual SlotBitmap fetch(const ITaskRepository *repo) const = 0;
+    virtual bool matches(Task *task) const = 0;
+    // Относительная стоимость проверки одной задачи (сравнение строк дороже сравнения чисел)
+    virtual int residualCost() const { return 1; }
+
+    // Фабрики предикатов. Недействительная граница диапазона дедлайнов - без ограничения
+    static QueryPredicatePtr title(const QString &keyword);
+    // Слова названия с опечатками (см. FuzzyTitleIndex)
+    static QueryPredicatePtr fuzzyTitle(const QString &text);
+    static QueryPredicatePtr priorityRange(Priority min, Priority max);
+    static QueryPredicatePtr project(Project *project);
+    static QueryPredicatePtr owner(User *owner);
+    static QueryPredicatePtr deadlineDay(const QDate &day);
+    static QueryPredicatePtr deadlineRange(const QDateTime &from, const QDateTime &to);
+    static QueryPredicatePtr completed(bool completed);
+    static QueryPredicatePtr negate(const QueryPredicatePtr &predicate);
+    // Не подходит ни одна задача (например, неизвестный владелец в запросе)
+    static QueryPredicatePtr none(const QString &reason);
+};
+
+// Планировщик запросов для FilterOptions (cost-based)
+// Предикаты упорядочиваются по оценке селективности. Самый селективный становится
+// путем доступа (кандидаты из индекса), остальные либо пересекаются с кандидатами
+// через индекс, либо проверяются на кандидатах напрямую - что дешевле
+class QueryPlanner
+{
+public:
+    enum StepMode {
+        FullScan,       // фильтров нет - все задачи
+        IndexAccess,    // кандидаты берутся из индекса
+        IndexIntersect, // пересечение битовой карты индекса с кандидатами
+        Residual        // проверка предиката на каждом кандидате
+    };
+
+    struct Step {
+        const QueryPredicate *predicate;
+        int estimate;
+        StepMode mode;
+    };
+
+    explicit QueryPlanner(const ITaskRepository *repo);
+
+    // Условия FilterOptions и дополнительные предикаты (скомпилированный запрос)
+    // планируются вместе как одна конъюнкция
+    void build(const TaskService::FilterOptions &filterOpts,
+               const QList<QueryPredicatePtr> &extra = QList<QueryPredicatePtr>());
+    QList<Task*> execute() const;
+
+    // Начиная с этого числа кандидатов прямые проверки выполняются кусками
+    // в пуле потоков (0 - всегда последовательно). Результат тот же, порядок сохраняется
+    void setParallelThreshold(int threshold) { m_parallelThreshold = threshold; }
+
+    // Текстовое описание выбранного плана для отладки
+    QString explain() const;
+
+    const QVector<Step> &steps() const { return m_steps; }
+    // Оценка числа кандидатов на пути доступа (все задачи, если фильтров нет)
+    int accessEstimate() const { return m_steps.isEmpty() ? m_total : m_steps.first().estimate; }
+
+private:
+    static QList<Task*> applyResiduals(const QList<Task*> &tasks, int begin, int end,
+                                       const QList<const QueryPredicate*> &residuals);
+
+    Q_DISABLE_COPY(QueryPlanner)
+
+    const ITaskRepository *m_repository;
+    QList<QueryPredicatePtr> m_predicates;
+    QVector<Step> m_steps;
+    int m_total;
+    int m_estimatedResult;
+    int m_parallelThreshold;
+};
+
+#endif // QUERYPLANNER_H
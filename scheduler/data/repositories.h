@@ -3,8 +3,11 @@
 
 #include <QList>
 #include <QDateTime>
+#include <QDate>
 #include <QString>
+#include <QStringList>
 #include "../models/task.h"
+#include "slotbitmap.h"
 
 class User;
 class Project;
@@ -29,6 +32,64 @@ public:
     virtual ~ITaskRepository() = default;
     virtual Task* findById(int id) const override = 0;
     virtual QList<Task*> searchByTitle(const QString &keyword) const = 0;
+    
+    // Поколение данных - увеличивается при любом изменении набора задач или их полей
+    virtual quint64 generation() const = 0;
+    
+    // Выборки по вторичным индексам - возвращают задачи в порядке добавления
+    virtual QList<Task*> findByOwner(User *owner) const = 0;
+    virtual QList<Task*> findByProject(Project *project) const = 0;
+    virtual QList<Task*> findByPriority(Priority priority) const = 0;
+    virtual QList<Task*> findByCompleted(bool completed) const = 0;
+    
+    // Выборки по упорядоченному индексу дедлайнов - результат отсортирован по дедлайну
+    // Полуинтервал [from, to); невалидная граница означает отсутствие ограничения
+    virtual QList<Task*> findByDeadlineRange(const QDateTime &from, const QDateTime &to,
+                                             bool activeOnly = false) const = 0;
+    // Первые limit задач с дедлайном не раньше from
+    virtual QList<Task*> findNextDue(const QDateTime &from, int limit,
+                                     bool activeOnly = true) const = 0;
+    // Наибольшее упреждение напоминания среди незавершенных задач с дедлайном (минуты)
+    virtual int maxReminderMinutes() const = 0;
+    
+    // Битовые карты слотов для композиции фильтров (AND / OR / AND NOT)
+    // без промежуточных списков задач; materialize превращает карту в задачи
+    virtual SlotBitmap allSlots() const = 0;
+    virtual SlotBitmap slotsByOwner(User *owner) const = 0;
+    virtual SlotBitmap slotsByProject(Project *project) const = 0;
+    virtual SlotBitmap slotsByPriority(Priority priority) const = 0;
+    virtual SlotBitmap slotsByCompleted(bool completed) const = 0;
+    virtual SlotBitmap slotsByTitle(const QString &keyword) const = 0;
+    // Нечеткий поиск: каждое слово запроса - в названии с опечаткой (1-2 правки)
+    virtual SlotBitmap slotsByFuzzyTitle(const QString &keyword) const = 0;
+    virtual SlotBitmap slotsByDeadlineDay(const QDate &day) const = 0;
+    // Задачи с дедлайном в полуинтервале [from, to); недействительная граница - без ограничения
+    virtual SlotBitmap slotsByDeadlineRange(const QDateTime &from, const QDateTime &to) const = 0;
+    virtual QList<Task*> materialize(const SlotBitmap &slotSet) const = 0;
+    
+    // Прямой доступ к слотам для потокового обхода без копии списка задач
+    // atSlot возвращает nullptr для освободившегося слота
+    virtual int slotCount() const = 0;
+    virtual Task* atSlot(int slot) const = 0;
+    
+    // Полнотекстовый поиск по названиям и описаниям: до limit задач по убыванию
+    // релевантности (BM25), слова в кавычках - фраза. scores - веса в том же порядке
+    virtual QList<Task*> searchFullText(const QString &query, int limit,
+                                        QList<double> *scores = nullptr) const = 0;
+    
+    // До limit названий, начинающихся с prefix (без учета регистра), самые частые первыми
+    virtual QStringList completeTitle(const QString &prefix, int limit) const = 0;
+    
+    // Почти одинаковые названия (MinHash/LSH, см. DuplicateIndex); threshold - нижняя
+    // граница оценки сходства 0..1. Группы - от двух задач, большие первыми
+    virtual QList<QList<Task*>> nearDuplicateClusters(double threshold) const = 0;
+    virtual QList<Task*> findNearDuplicates(const QString &title, double threshold) const = 0;
+    
+    // Статистика индексов для планировщика запросов (оценки сверху)
+    virtual int estimateTitleMatches(const QString &keyword) const = 0;
+    virtual int estimateFuzzyTitleMatches(const QString &keyword) const = 0;
+    virtual int estimateDeadlineDay(const QDate &day) const = 0;
+    virtual int estimateDeadlineRange(const QDateTime &from, const QDateTime &to) const = 0;
 };
 
 class IUserRepository : public IRepository<User>
@@ -36,7 +97,12 @@ class IUserRepository : public IRepository<User>
 public:
     virtual ~IUserRepository() = default;
     virtual User* findById(int id) const override = 0;
+    // Поиск по имени через хеш-индекс: точное совпадение, затем без учета регистра и пробелов
     virtual User* findByName(const QString &name) const = 0;
+    // Переименование через репозиторий поддерживает индекс имен в актуальном состоянии
+    virtual void rename(User *user, const QString &name) = 0;
+    // До limit имен, начинающихся с prefix (без учета регистра и пробелов по краям)
+    virtual QStringList completeName(const QString &prefix, int limit) const = 0;
 };
 
 class IProjectRepository : public IRepository<Project>
@@ -44,7 +110,12 @@ class IProjectRepository : public IRepository<Project>
 public:
     virtual ~IProjectRepository() = default;
     virtual Project* findById(int id) const override = 0;
+    // Поиск по имени через хеш-индекс: точное совпадение, затем без учета регистра и пробелов
     virtual Project* findByName(const QString &name) const = 0;
+    // Переименование через репозиторий поддерживает индекс имен в актуальном состоянии
+    virtual void rename(Project *project, const QString &name) = 0;
+    // До limit имен, начинающихся с prefix (без учета регистра и пробелов по краям)
+    virtual QStringList completeName(const QString &prefix, int limit) const = 0;
 };
 
 #endif // REPOSITORIES_H
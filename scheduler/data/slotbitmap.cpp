@@ -0,0 +1,353 @@
+#include "slotbitmap.h"
+#include <algorithm>
+
+SlotBitmap SlotBitmap::fromSortedSlots(const QVector<int> &sortedSlots)
+{
+    SlotBitmap result;
+    for (int slot : sortedSlots) {
+        quint16 key = quint16(slot >> 16);
+        if (result.m_containers.isEmpty() || result.m_containers.last().key != key) {
+            Container c;
+            c.key = key;
+            c.cardinality = 0;
+            result.m_containers.append(c);
+        }
+        Container &c = result.m_containers.last();
+        quint16 low = quint16(slot & 0xFFFF);
+        if (c.cardinality == 0 || c.array.last() != low) {
+            c.array.append(low);
+            ++c.cardinality;
+        }
+    }
+    for (Container &c : result.m_containers) {
+        c.normalize();
+    }
+    return result;
+}
+
+int SlotBitmap::count() const
+{
+    int total = 0;
+    for (const Container &c : m_containers) {
+        total += c.cardinality;
+    }
+    return total;
+}
+
+bool SlotBitmap::contains(int slot) const
+{
+    int index = findContainer(quint16(slot >> 16));
+    return index >= 0 && m_containers.at(index).contains(quint16(slot & 0xFFFF));
+}
+
+void SlotBitmap::insert(int slot)
+{
+    quint16 key = quint16(slot >> 16);
+    quint16 low = quint16(slot & 0xFFFF);
+
+    // Новые слоты обычно больше всех существующих - проверяем последний блок первым
+    int index;
+    if (!m_containers.isEmpty() && m_containers.last().key == key) {
+        index = m_containers.size() - 1;
+    } else {
+        index = findContainer(key);
+    }
+    if (index < 0) {
+        Container c;
+        c.key = key;
+        c.cardinality = 0;
+        QVector<Container>::iterator pos = std::lower_bound(
+            m_containers.begin(), m_containers.end(), key,
+            [](const Container &item, quint16 k) { return item.key < k; });
+        index = int(pos - m_containers.begin());
+        m_containers.insert(index, c);
+    }
+
+    Container &c = m_containers[index];
+    if (c.isBitset()) {
+        quint64 &word = c.bits[low >> 6];
+        quint64 mask = quint64(1) << (low & 63);
+        if (!(word & mask)) {
+            word |= mask;
+            ++c.cardinality;
+        }
+        return;
+    }
+
+    if (c.array.isEmpty() || c.array.last() < low) {
+        c.array.append(low);
+    } else {
+        QVector<quint16>::iterator it = std::lower_bound(c.array.begin(), c.array.end(), low);
+        if (*it == low) {
+            return;
+        }
+        c.array.insert(it, low);
+    }
+    ++c.cardinality;
+    if (c.cardinality > ARRAY_LIMIT) {
+        c.toBitset();
+    }
+}
+
+void SlotBitmap::remove(int slot)
+{
+    int index = findContainer(quint16(slot >> 16));
+    if (index < 0) {
+        return;
+    }
+
+    Container &c = m_containers[index];
+    quint16 low = quint16(slot & 0xFFFF);
+    if (c.isBitset()) {
+        quint64 &word = c.bits[low >> 6];
+        quint64 mask = quint64(1) << (low & 63);
+        if (!(word & mask)) {
+            return;
+        }
+        word &= ~mask;
+        --c.cardinality;
+        // Обратно в массив переходим с запасом, чтобы не переключаться туда-обратно на границе
+        if (c.cardinality <= ARRAY_LIMIT / 2) {
+            c.toArray();
+        }
+    } else {
+        QVector<quint16>::iterator it = std::lower_bound(c.array.begin(), c.array.end(), low);
+        if (it == c.array.end() || *it != low) {
+            return;
+        }
+        c.array.erase(it);
+        --c.cardinality;
+    }
+
+    if (c.cardinality == 0) {
+        m_containers.remove(index);
+    }
+}
+
+SlotBitmap SlotBitmap::operator&(const SlotBitmap &other) const
+{
+    SlotBitmap result;
+    int i = 0;
+    int j = 0;
+    while (i < m_containers.size() && j < other.m_containers.size()) {
+        const Container &a = m_containers.at(i);
+        const Container &b = other.m_containers.at(j);
+        if (a.key < b.key) {
+            ++i;
+        } else if (b.key < a.key) {
+            ++j;
+        } else {
+            Container c = intersect(a, b);
+            if (c.cardinality > 0) {
+                result.m_containers.append(c);
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return result;
+}
+
+SlotBitmap SlotBitmap::operator|(const SlotBitmap &other) const
+{
+    SlotBitmap result;
+    int i = 0;
+    int j = 0;
+    while (i < m_containers.size() || j < other.m_containers.size()) {
+        if (j == other.m_containers.size() ||
+            (i < m_containers.size() && m_containers.at(i).key < other.m_containers.at(j).key)) {
+            result.m_containers.append(m_containers.at(i++));
+        } else if (i == m_containers.size() ||
+                   other.m_containers.at(j).key < m_containers.at(i).key) {
+            result.m_containers.append(other.m_containers.at(j++));
+        } else {
+            result.m_containers.append(unite(m_containers.at(i++), other.m_containers.at(j++)));
+        }
+    }
+    return result;
+}
+
+SlotBitmap SlotBitmap::andNot(const SlotBitmap &other) const
+{
+    SlotBitmap result;
+    int j = 0;
+    for (const Container &a : m_containers) {
+        while (j < other.m_containers.size() && other.m_containers.at(j).key < a.key) {
+            ++j;
+        }
+        if (j < other.m_containers.size() && other.m_containers.at(j).key == a.key) {
+            Container c = subtract(a, other.m_containers.at(j));
+            if (c.cardinality > 0) {
+                result.m_containers.append(c);
+            }
+        } else {
+            result.m_containers.append(a);
+        }
+    }
+    return result;
+}
+
+QVector<int> SlotBitmap::toVector() const
+{
+    QVector<int> result;
+    result.reserve(count());
+    forEach([&result](int slot) { result.append(slot); });
+    return result;
+}
+
+int SlotBitmap::findContainer(quint16 key) const
+{
+    QVector<Container>::const_iterator it = std::lower_bound(
+        m_containers.constBegin(), m_containers.constEnd(), key,
+        [](const Container &item, quint16 k) { return item.key < k; });
+    if (it != m_containers.constEnd() && it->key == key) {
+        return int(it - m_containers.constBegin());
+    }
+    return -1;
+}
+
+SlotBitmap::Container SlotBitmap::intersect(const Container &a, const Container &b)
+{
+    Container c;
+    c.key = a.key;
+    c.cardinality = 0;
+
+    if (a.isBitset() && b.isBitset()) {
+        c.bits.resize(WORDS);
+        for (int w = 0; w < WORDS; ++w) {
+            quint64 word = a.bits.at(w) & b.bits.at(w);
+            c.bits[w] = word;
+            c.cardinality += qPopulationCount(word);
+        }
+        c.normalize();
+        return c;
+    }
+
+    if (a.isBitset() || b.isBitset()) {
+        // Массив проверяется по битовому полю
+        const Container &arr = a.isBitset() ? b : a;
+        const Container &set = a.isBitset() ? a : b;
+        for (quint16 low : arr.array) {
+            if (set.contains(low)) {
+                c.array.append(low);
+            }
+        }
+        c.cardinality = c.array.size();
+        return c;
+    }
+
+    std::set_intersection(a.array.constBegin(), a.array.constEnd(),
+                          b.array.constBegin(), b.array.constEnd(),
+                          std::back_inserter(c.array));
+    c.cardinality = c.array.size();
+    return c;
+}
+
+SlotBitmap::Container SlotBitmap::unite(const Container &a, const Container &b)
+{
+    Container c;
+    c.key = a.key;
+    c.cardinality = 0;
+
+    if (!a.isBitset() && !b.isBitset() && a.cardinality + b.cardinality <= ARRAY_LIMIT) {
+        std::set_union(a.array.constBegin(), a.array.constEnd(),
+                       b.array.constBegin(), b.array.constEnd(),
+                       std::back_inserter(c.array));
+        c.cardinality = c.array.size();
+        return c;
+    }
+
+    Container left = a;
+    left.toBitset();
+    Container right = b;
+    right.toBitset();
+    c.bits.resize(WORDS);
+    for (int w = 0; w < WORDS; ++w) {
+        quint64 word = left.bits.at(w) | right.bits.at(w);
+        c.bits[w] = word;
+        c.cardinality += qPopulationCount(word);
+    }
+    c.normalize();
+    return c;
+}
+
+SlotBitmap::Container SlotBitmap::subtract(const Container &a, const Container &b)
+{
+    Container c;
+    c.key = a.key;
+    c.cardinality = 0;
+
+    if (!a.isBitset()) {
+        for (quint16 low : a.array) {
+            if (!b.contains(low)) {
+                c.array.append(low);
+            }
+        }
+        c.cardinality = c.array.size();
+        return c;
+    }
+
+    c.bits = a.bits;
+    if (b.isBitset()) {
+        for (int w = 0; w < WORDS; ++w) {
+            c.bits[w] &= ~b.bits.at(w);
+        }
+    } else {
+        for (quint16 low : b.array) {
+            c.bits[low >> 6] &= ~(quint64(1) << (low & 63));
+        }
+    }
+    for (int w = 0; w < WORDS; ++w) {
+        c.cardinality += qPopulationCount(c.bits.at(w));
+    }
+    c.normalize();
+    return c;
+}
+
+bool SlotBitmap::Container::contains(quint16 low) const
+{
+    if (isBitset()) {
+        return (bits.at(low >> 6) >> (low & 63)) & 1;
+    }
+    return std::binary_search(array.constBegin(), array.constEnd(), low);
+}
+
+void SlotBitmap::Container::toBitset()
+{
+    if (isBitset()) {
+        return;
+    }
+    bits.fill(0, WORDS);
+    for (quint16 low : array) {
+        bits[low >> 6] |= quint64(1) << (low & 63);
+    }
+    array.clear();
+    array.squeeze();
+}
+
+void SlotBitmap::Container::toArray()
+{
+    if (!isBitset()) {
+        return;
+    }
+    array.reserve(cardinality);
+    for (int w = 0; w < WORDS; ++w) {
+        quint64 word = bits.at(w);
+        while (word) {
+            array.append(quint16((w << 6) + int(qCountTrailingZeroBits(word))));
+            word &= word - 1;
+        }
+    }
+    bits.clear();
+    bits.squeeze();
+}
+
+// Выбирает представление блока по количеству элементов
+void SlotBitmap::Container::normalize()
+{
+    if (cardinality > ARRAY_LIMIT) {
+        toBitset();
+    } else {
+        toArray();
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef SLOTBITMAP_H
+#define SLOTBITMAP_H
+
+#include <QVector>
+#include <QtGlobal>
+#include <QtAlgorithms>
+
+// Сжатая битовая карта номеров слотов (по мотивам Roaring bitmap)
+// Пространство слотов делится на блоки по 65536 значений. Редкий блок хранится
+// отсортированным массивом 16-битных смещений, плотный - битовым полем из 1024 слов.
+// Поддерживает AND / OR / AND NOT без материализации списков задач;
+// обход всегда идет по возрастанию слотов, т.е. в порядке добавления задач
+class SlotBitmap
+{
+public:
+    SlotBitmap() {}
+
+    static SlotBitmap fromSortedSlots(const QVector<int> &sortedSlots);
+
+    bool isEmpty() const { return m_containers.isEmpty(); }
+    int count() const;
+    bool contains(int slot) const;
+
+    void insert(int slot);
+    void remove(int slot);
+    void clear() { m_containers.clear(); }
+
+    SlotBitmap operator&(const SlotBitmap &other) const;
+    SlotBitmap operator|(const SlotBitmap &other) const;
+    // Разность множеств (this AND NOT other)
+    SlotBitmap andNot(const SlotBitmap &other) const;
+
+    SlotBitmap &operator&=(const SlotBitmap &other) { return *this = *this & other; }
+    SlotBitmap &operator|=(const SlotBitmap &other) { return *this = *this | other; }
+
+    QVector<int> toVector() const;
+
+    // Вызывает f(slot) для каждого слота по возрастанию
+    template<typename F>
+    void forEach(F f) const
+    {
+        for (const Container &c : m_containers) {
+            const int base = int(c.key) << 16;
+            if (c.isBitset()) {
+                for (int w = 0; w < WORDS; ++w) {
+                    quint64 word = c.bits.at(w);
+                    while (word) {
+                        f(base + (w << 6) + int(qCountTrailingZeroBits(word)));
+                        word &= word - 1;
+                    }
+                }
+            } else {
+                for (quint16 low : c.array) {
+                    f(base + low);
+                }
+            }
+        }
+    }
+
+private:
+    // Блок превращается в битовое поле, когда в массиве больше 4096 элементов
+    // (в этот момент массив занимает столько же памяти, сколько битовое поле)
+    static const int ARRAY_LIMIT = 4096;
+    static const int WORDS = 1024;
+
+    struct Container {
+        quint16 key;             // старшие 16 бит слота
+        int cardinality;
+        QVector<quint16> array;  // отсортированные младшие биты (редкий блок)
+        QVector<quint64> bits;   // битовое поле (плотный блок)
+
+        bool isBitset() const { return !bits.isEmpty(); }
+        bool contains(quint16 low) const;
+        void toBitset();
+        void toArray();
+        void normalize();
+    };
+
+    int findContainer(quint16 key) const;
+
+    static Container intersect(const Container &a, const Container &b);
+    static Container unite(const Container &a, const Container &b);
+    static Container subtract(const Container &a, const Container &b);
+
+    QVector<Container> m_containers; // отсортированы по key
+};
+
+#endif // SLOTBITMAP_H
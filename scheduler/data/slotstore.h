@@ -0,0 +1,138 @@
+#ifndef SLOTSTORE_H
+#define SLOTSTORE_H
+
+#include <QVector>
+#include <QList>
+#include <QHash>
+
+// Плотное хранилище сущностей для репозиториев
+// Каждый элемент получает слот - порядковый номер вставки. Удаление оставляет
+// "дыру" в слоте, поэтому порядок обхода совпадает с порядком добавления.
+// Поиск по ID, проверка принадлежности и удаление выполняются за O(1) через хеш-индексы,
+// при большом количестве дыр хранилище уплотняется (амортизированно O(1))
+template<typename T>
+class SlotStore
+{
+public:
+    SlotStore() : m_size(0), m_listValid(true) {}
+
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    bool contains(T *item) const { return m_slotOf.contains(item); }
+
+    // Количество слотов, включая освобожденные (верхняя граница для индексов по слотам)
+    int slotCount() const { return m_items.size(); }
+    T* at(int slot) const { return m_items.at(slot); }
+    int slotOf(T *item) const { return m_slotOf.value(item, -1); }
+
+    T* findById(int id) const { return m_byId.value(id, nullptr); }
+
+    // Добавляет элемент в конец, возвращает его слот
+    int insert(T *item)
+    {
+        int slot = m_items.size();
+        m_items.append(item);
+        m_slotOf.insert(item, slot);
+        m_byId.insert(item->getId(), item);
+        ++m_size;
+        if (m_listValid) {
+            m_list.append(item);
+        }
+        return slot;
+    }
+
+    // Освобождает слот элемента, возвращает его номер или -1
+    int take(T *item)
+    {
+        typename QHash<T*, int>::iterator it = m_slotOf.find(item);
+        if (it == m_slotOf.end()) {
+            return -1;
+        }
+        int slot = it.value();
+        m_slotOf.erase(it);
+        // ID мог быть занят другим элементом с тем же ID - удаляем только свою запись
+        typename QHash<int, T*>::iterator idIt = m_byId.find(item->getId());
+        if (idIt != m_byId.end() && idIt.value() == item) {
+            m_byId.erase(idIt);
+        }
+        m_items[slot] = nullptr;
+        --m_size;
+        m_listValid = false;
+        return slot;
+    }
+
+    // Уплотнение нужно, когда дыр больше половины слотов
+    bool isSparse() const { return m_items.size() > 64 && m_size * 2 < m_items.size(); }
+
+    // Перенумеровывает слоты без дыр с сохранением порядка
+    // Возвращает отображение старый слот -> новый (-1 для освобожденных):
+    // индексы, построенные по номерам слотов, переносятся по нему (см. remapSlots)
+    QVector<int> compact()
+    {
+        QVector<int> slots(m_items.size(), -1);
+        QVector<T*> items;
+        items.reserve(m_size);
+        for (int slot = 0; slot < m_items.size(); ++slot) {
+            T *item = m_items.at(slot);
+            if (item) {
+                slots[slot] = items.size();
+                m_slotOf[item] = items.size();
+                items.append(item);
+            }
+        }
+        m_items = items;
+        return slots;
+    }
+
+    void clear()
+    {
+        m_items.clear();
+        m_slotOf.clear();
+        m_byId.clear();
+        m_list.clear();
+        m_size = 0;
+        m_listValid = true;
+    }
+
+    // Элементы в порядке добавления. Список кешируется и разделяется неявно (COW),
+    // поэтому повторные вызовы без изменений не копируют данные
+    QList<T*> items() const
+    {
+        if (!m_listValid) {
+            m_list.clear();
+            m_list.reserve(m_size);
+            for (T *item : m_items) {
+                if (item) {
+                    m_list.append(item);
+                }
+            }
+            m_listValid = true;
+        }
+        return m_list;
+    }
+
+private:
+    QVector<T*> m_items;          // слот -> элемент (nullptr для освобожденных)
+    QHash<T*, int> m_slotOf;      // элемент -> слот
+    QHash<int, T*> m_byId;        // ID -> элемент
+    int m_size;
+    mutable QList<T*> m_list;
+    mutable bool m_listValid;
+};
+
+// Переносит список слотов на нумерацию после SlotStore::compact()
+// Отображение сохраняет порядок, поэтому отсортированный список остается отсортированным;
+// освобожденные слоты из списка выбрасываются
+inline void remapSlots(QVector<int> &list, const QVector<int> &slots)
+{
+    int size = 0;
+    for (int slot : list) {
+        int mapped = slot < slots.size() ? slots.at(slot) : -1;
+        if (mapped >= 0) {
+            list[size++] = mapped;
+        }
+    }
+    list.resize(size);
+}
+
+#endif // SLOTSTORE_H
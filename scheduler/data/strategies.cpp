@@ -1,38 +1,40 @@
 #include "strategies.h"
 #include "../models/project.h"
 #include "../models/user.h"
+#include "tasksortkey.h"
+#include "casefoldsearch.h"
+#include <QVector>
 #include <algorithm>
 
-PriorityFilterStrategy::PriorityFilterStrategy(Priority priority)
-    : m_priority(priority)
-{
-}
-
-QList<Task*> PriorityFilterStrategy::filter(const QList<Task*> &tasks) const
+QList<Task*> PredicateFilterStrategy::filter(const QList<Task*> &tasks) const
 {
     QList<Task*> result;
     for (Task *task : tasks) {
-        if (task->getPriority() == m_priority) {
+        if (matches(task)) {
             result.append(task);
         }
     }
     return result;
 }
 
+PriorityFilterStrategy::PriorityFilterStrategy(Priority priority)
+    : m_priority(priority)
+{
+}
+
+bool PriorityFilterStrategy::matches(Task *task) const
+{
+    return task->getPriority() == m_priority;
+}
+
 DateFilterStrategy::DateFilterStrategy(const QDateTime &date)
     : m_date(date)
 {
 }
 
-QList<Task*> DateFilterStrategy::filter(const QList<Task*> &tasks) const
+bool DateFilterStrategy::matches(Task *task) const
 {
-    QList<Task*> result;
-    for (Task *task : tasks) {
-        if (task->getDeadline().date() == m_date.date()) {
-            result.append(task);
-        }
-    }
-    return result;
+    return task->getDeadline().date() == m_date.date();
 }
 
 ProjectFilterStrategy::ProjectFilterStrategy(Project *project)
@@ -40,15 +42,9 @@ ProjectFilterStrategy::ProjectFilterStrategy(Project *project)
 {
 }
 
-QList<Task*> ProjectFilterStrategy::filter(const QList<Task*> &tasks) const
+bool ProjectFilterStrategy::matches(Task *task) const
 {
-    QList<Task*> result;
-    for (Task *task : tasks) {
-        if (task->getProject() == m_project) {
-            result.append(task);
-        }
-    }
-    return result;
+    return task->getProject() == m_project;
 }
 
 UserFilterStrategy::UserFilterStrategy(User *user)
@@ -56,15 +52,9 @@ UserFilterStrategy::UserFilterStrategy(User *user)
 {
 }
 
-QList<Task*> UserFilterStrategy::filter(const QList<Task*> &tasks) const
+bool UserFilterStrategy::matches(Task *task) const
 {
-    QList<Task*> result;
-    for (Task *task : tasks) {
-        if (task->getOwner() == m_user) {
-            result.append(task);
-        }
-    }
-    return result;
+    return task->getOwner() == m_user;
 }
 
 CompletedFilterStrategy::CompletedFilterStrategy(bool completed)
@@ -72,31 +62,20 @@ CompletedFilterStrategy::CompletedFilterStrategy(bool completed)
 {
 }
 
-QList<Task*> CompletedFilterStrategy::filter(const QList<Task*> &tasks) const
+bool CompletedFilterStrategy::matches(Task *task) const
 {
-    QList<Task*> result;
-    for (Task *task : tasks) {
-        if (task->isCompleted() == m_completed) {
-            result.append(task);
-        }
-    }
-    return result;
+    return task->isCompleted() == m_completed;
 }
 
 TitleSearchFilterStrategy::TitleSearchFilterStrategy(const QString &keyword)
-    : m_keyword(keyword.toLower())
+    : m_keyword(keyword)
 {
 }
 
-QList<Task*> TitleSearchFilterStrategy::filter(const QList<Task*> &tasks) const
+// Сравнение без учета регистра выполняется на месте, без копии названия в нижнем регистре
+bool TitleSearchFilterStrategy::matches(Task *task) const
 {
-    QList<Task*> result;
-    for (Task *task : tasks) {
-        if (task->getTitle().toLower().contains(m_keyword)) {
-            result.append(task);
-        }
-    }
-    return result;
+    return CaseFoldSearch::containsFolded(task->getFoldedTitle(), m_keyword);
 }
 
 SortByDateStrategy::SortByDateStrategy(bool ascending)
@@ -106,10 +85,7 @@ SortByDateStrategy::SortByDateStrategy(bool ascending)
 
 void SortByDateStrategy::sort(QList<Task*> &tasks) const
 {
-    std::sort(tasks.begin(), tasks.end(), [this](Task *a, Task *b) {
-        bool less = a->getDeadline() < b->getDeadline();
-        return m_ascending ? less : !less;
-    });
+    TaskKeySorter::sortByKey(tasks, &TaskKeySorter::deadlineKey, m_ascending);
 }
 
 SortByPriorityStrategy::SortByPriorityStrategy(bool ascending)
@@ -119,10 +95,9 @@ SortByPriorityStrategy::SortByPriorityStrategy(bool ascending)
 
 void SortByPriorityStrategy::sort(QList<Task*> &tasks) const
 {
-    std::sort(tasks.begin(), tasks.end(), [this](Task *a, Task *b) {
-        bool less = static_cast<int>(a->getPriority()) < static_cast<int>(b->getPriority());
-        return m_ascending ? less : !less;
-    });
+    TaskKeySorter::sortByKey(tasks, [](Task *task) {
+        return quint64(static_cast<int>(task->getPriority()));
+    }, m_ascending);
 }
 
 SortByTitleStrategy::SortByTitleStrategy(bool ascending)
@@ -132,10 +107,24 @@ SortByTitleStrategy::SortByTitleStrategy(bool ascending)
 
 void SortByTitleStrategy::sort(QList<Task*> &tasks) const
 {
-    std::sort(tasks.begin(), tasks.end(), [this](Task *a, Task *b) {
-        bool less = a->getTitle() < b->getTitle();
-        return m_ascending ? less : !less;
+    // Ключи сопоставления кешированы в задачах - сравнение побайтовое, с учетом локали
+    QList<QCollatorSortKey> keys;
+    keys.reserve(tasks.size());
+    QVector<int> order(tasks.size());
+    for (int i = 0; i < tasks.size(); ++i) {
+        keys.append(tasks.at(i)->getTitleSortKey());
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [this, &keys](int a, int b) {
+        int cmp = keys.at(a).compare(keys.at(b));
+        return m_ascending ? cmp < 0 : cmp > 0;
     });
+    QList<Task*> sorted;
+    sorted.reserve(tasks.size());
+    for (int index : order) {
+        sorted.append(tasks.at(index));
+    }
+    tasks = sorted;
 }
 
 SortByProjectStrategy::SortByProjectStrategy(bool ascending)
@@ -145,11 +134,55 @@ SortByProjectStrategy::SortByProjectStrategy(bool ascending)
 
 void SortByProjectStrategy::sort(QList<Task*> &tasks) const
 {
-    std::sort(tasks.begin(), tasks.end(), [this](Task *a, Task *b) {
-        QString projA = a->getProject() ? a->getProject()->getName() : "";
-        QString projB = b->getProject() ? b->getProject()->getName() : "";
-        bool less = projA < projB;
-        return m_ascending ? less : !less;
-    });
+    // Названия проектов сравниваются один раз при построении порядковых номеров
+    QHash<Project*, quint32> ordinals = TaskKeySorter::projectOrdinals(tasks);
+    TaskKeySorter::sortByKey(tasks, [&ordinals](Task *task) {
+        return quint64(ordinals.value(task->getProject()));
+    }, m_ascending);
+}
+
+
+SortByCompletedStrategy::SortByCompletedStrategy(bool ascending)
+    : m_ascending(ascending)
+{
+}
+
+void SortByCompletedStrategy::sort(QList<Task*> &tasks) const
+{
+    TaskKeySorter::sortByKey(tasks, [](Task *task) {
+        return quint64(task->isCompleted() ? 1 : 0);
+    }, m_ascending);
+}
+
+CompositeSortStrategy::CompositeSortStrategy(const QList<const ISortStrategy*> &parts)
+{
+    for (const ISortStrategy *part : parts) {
+        if (part) {
+            m_keys.append(part->key());
+        }
+    }
+}
+
+CompositeSortStrategy::CompositeSortStrategy(const QList<SortKey> &keys)
+    : m_keys(keys)
+{
 }
 
+void CompositeSortStrategy::sort(QList<Task*> &tasks) const
+{
+    TaskSortOrder(m_keys).sort(tasks);
+}
+
+bool CompositeSortStrategy::ascending() const
+{
+    return m_keys.isEmpty() || m_keys.first().ascending;
+}
+
+SortKey CompositeSortStrategy::key() const
+{
+    if (m_keys.isEmpty()) {
+        SortKey k = { SortKey::ByCompleted, true };
+        return k;
+    }
+    return m_keys.first();
+}
@@ -19,69 +19,90 @@ public:
     virtual QList<Task*> filter(const QList<Task*> &tasks) const = 0;
 };
 
+// Адаптер для стратегий, которые задаются проверкой одной задачи:
+// filter() - один проход по списку с matches(). Составной предикат
+// TaskFilter становится такой стратегией через FusedFilterStrategy
+class PredicateFilterStrategy : public IFilterStrategy
+{
+public:
+    virtual bool matches(Task *task) const = 0;
+    QList<Task*> filter(const QList<Task*> &tasks) const final;
+};
+
+// Элемент составного ключа сортировки: поле и направление
+struct SortKey {
+    enum Field { ByCompleted, ByDate, ByPriority, ByTitle, ByProject };
+    Field field;
+    bool ascending;
+
+    bool operator==(const SortKey &other) const { return field == other.field && ascending == other.ascending; }
+};
+
 class ISortStrategy
 {
 public:
     virtual ~ISortStrategy() = default;
     virtual void sort(QList<Task*> &tasks) const = 0;
     virtual bool ascending() const = 0;
+    // Ключ стратегии - строительный блок для CompositeSortStrategy
+    virtual SortKey key() const = 0;
 };
 
-class PriorityFilterStrategy : public IFilterStrategy
+class PriorityFilterStrategy : public PredicateFilterStrategy
 {
 public:
     explicit PriorityFilterStrategy(Priority priority);
-    QList<Task*> filter(const QList<Task*> &tasks) const override;
+    bool matches(Task *task) const override;
 
 private:
     Priority m_priority;
 };
 
-class DateFilterStrategy : public IFilterStrategy
+class DateFilterStrategy : public PredicateFilterStrategy
 {
 public:
     explicit DateFilterStrategy(const QDateTime &date);
-    QList<Task*> filter(const QList<Task*> &tasks) const override;
+    bool matches(Task *task) const override;
 
 private:
     QDateTime m_date;
 };
 
-class ProjectFilterStrategy : public IFilterStrategy
+class ProjectFilterStrategy : public PredicateFilterStrategy
 {
 public:
     explicit ProjectFilterStrategy(Project *project);
-    QList<Task*> filter(const QList<Task*> &tasks) const override;
+    bool matches(Task *task) const override;
 
 private:
     Project *m_project;
 };
 
-class UserFilterStrategy : public IFilterStrategy
+class UserFilterStrategy : public PredicateFilterStrategy
 {
 public:
     explicit UserFilterStrategy(User *user);
-    QList<Task*> filter(const QList<Task*> &tasks) const override;
+    bool matches(Task *task) const override;
 
 private:
     User *m_user;
 };
 
-class CompletedFilterStrategy : public IFilterStrategy
+class CompletedFilterStrategy : public PredicateFilterStrategy
 {
 public:
     explicit CompletedFilterStrategy(bool completed);
-    QList<Task*> filter(const QList<Task*> &tasks) const override;
+    bool matches(Task *task) const override;
 
 private:
     bool m_completed;
 };
 
-class TitleSearchFilterStrategy : public IFilterStrategy
+class TitleSearchFilterStrategy : public PredicateFilterStrategy
 {
 public:
     explicit TitleSearchFilterStrategy(const QString &keyword);
-    QList<Task*> filter(const QList<Task*> &tasks) const override;
+    bool matches(Task *task) const override;
 
 private:
     QString m_keyword;
@@ -93,6 +114,7 @@ public:
     explicit SortByDateStrategy(bool ascending = true);
     void sort(QList<Task*> &tasks) const override;
     bool ascending() const override { return m_ascending; }
+    SortKey key() const override { SortKey k = { SortKey::ByDate, m_ascending }; return k; }
 
 private:
     bool m_ascending;
@@ -104,6 +126,7 @@ public:
     explicit SortByPriorityStrategy(bool ascending = true);
     void sort(QList<Task*> &tasks) const override;
     bool ascending() const override { return m_ascending; }
+    SortKey key() const override { SortKey k = { SortKey::ByPriority, m_ascending }; return k; }
 
 private:
     bool m_ascending;
@@ -115,6 +138,7 @@ public:
     explicit SortByTitleStrategy(bool ascending = true);
     void sort(QList<Task*> &tasks) const override;
     bool ascending() const override { return m_ascending; }
+    SortKey key() const override { SortKey k = { SortKey::ByTitle, m_ascending }; return k; }
 
 private:
     bool m_ascending;
@@ -126,10 +150,43 @@ public:
     explicit SortByProjectStrategy(bool ascending = true);
     void sort(QList<Task*> &tasks) const override;
     bool ascending() const override { return m_ascending; }
+    SortKey key() const override { SortKey k = { SortKey::ByProject, m_ascending }; return k; }
 
 private:
     bool m_ascending;
 };
 
+// Незавершенные задачи перед завершенными (при ascending = true)
+class SortByCompletedStrategy : public ISortStrategy
+{
+public:
+    explicit SortByCompletedStrategy(bool ascending = true);
+    void sort(QList<Task*> &tasks) const override;
+    bool ascending() const override { return m_ascending; }
+    SortKey key() const override { SortKey k = { SortKey::ByCompleted, m_ascending }; return k; }
+
+private:
+    bool m_ascending;
+};
+
+// Составная сортировка из нескольких стратегий, например
+// "приоритет по убыванию, затем дедлайн, затем название"
+// Ключи стратегий собираются в один плоский ключ, и сортировка делает один проход
+// сравнений без цепочки виртуальных вызовов. Стратегии-части не хранятся
+class CompositeSortStrategy : public ISortStrategy
+{
+public:
+    explicit CompositeSortStrategy(const QList<const ISortStrategy*> &parts);
+    explicit CompositeSortStrategy(const QList<SortKey> &keys);
+    void sort(QList<Task*> &tasks) const override;
+    // Направление первого ключа
+    bool ascending() const override;
+    SortKey key() const override;
+    const QList<SortKey> &keys() const { return m_keys; }
+
+private:
+    QList<SortKey> m_keys;
+};
+
 #endif // STRATEGIES_H
 
@@ -1,11 +1,21 @@
 #include "taskrepository.h"
+#include "casefoldsearch.h"
 #include "../models/task.h"
 #include "../models/user.h"
 #include "../models/project.h"
+#include <QTime>
+#include <algorithm>
+#include <limits>
 
 TaskRepository::TaskRepository(QObject *parent)
-    : QObject(parent), m_nextTaskId(1)
+    : QObject(parent), m_nextTaskId(1), m_generation(0)
 {
+    m_dispatcher.setAboutToChangeHandler([this](Task *task, Task::Fields changing) {
+        onTaskAboutToChange(task, changing);
+    });
+    m_dispatcher.setHandler([this](Task *task, Task::Fields changed) {
+        onTaskChanged(task, changed);
+    });
 }
 
 void TaskRepository::add(Task *task)
@@ -15,45 +25,590 @@ void TaskRepository::add(Task *task)
         if (task->getId() < 0) {
             task->setId(m_nextTaskId++);
         }
-        m_tasks.append(task);
+        int slot = m_tasks.insert(task);
+        indexTask(slot, task);
+        ++m_generation;
+        // Сеттеры задачи сообщают об изменениях диспетчеру репозитория
+        task->setDispatcher(&m_dispatcher);
         emit taskAdded(task); // Уведомляем подписчиков (TaskService, UI)
     }
 }
 
 void TaskRepository::remove(Task *task)
 {
-    if (m_tasks.removeAll(task) > 0) {
+    int slot = m_tasks.take(task);
+    if (slot >= 0) {
+        task->setDispatcher(nullptr);
+        unindexTask(slot, task);
+        ++m_generation;
+        if (m_tasks.isSparse()) {
+            compact();
+        }
         emit taskRemoved(task);
     }
 }
 
 Task* TaskRepository::findById(int id) const
 {
-    for (Task *task : m_tasks) {
-        if (task->getId() == id) {
-            return task;
-        }
-    }
-    return nullptr;
+    return m_tasks.findById(id);
 }
 
 void TaskRepository::clear()
 {
+    for (Task *task : m_tasks.items()) {
+        task->setDispatcher(nullptr);
+    }
     m_tasks.clear();
+    rebuildIndexes();
+    ++m_generation;
     m_nextTaskId = 1;
 }
 
 QList<Task*> TaskRepository::searchByTitle(const QString &keyword) const
+{
+    return materialize(slotsByTitle(keyword));
+}
+
+QList<Task*> TaskRepository::findByOwner(User *owner) const
+{
+    return materialize(slotsByOwner(owner));
+}
+
+QList<Task*> TaskRepository::findByProject(Project *project) const
+{
+    return materialize(slotsByProject(project));
+}
+
+QList<Task*> TaskRepository::findByPriority(Priority priority) const
+{
+    return materialize(slotsByPriority(priority));
+}
+
+QList<Task*> TaskRepository::findByCompleted(bool completed) const
+{
+    return materialize(slotsByCompleted(completed));
+}
+
+SlotBitmap TaskRepository::slotsByOwner(User *owner) const
+{
+    return m_byOwner.value(owner);
+}
+
+SlotBitmap TaskRepository::slotsByProject(Project *project) const
+{
+    return m_byProject.value(project);
+}
+
+SlotBitmap TaskRepository::slotsByPriority(Priority priority) const
+{
+    return m_byPriority.value(static_cast<int>(priority));
+}
+
+SlotBitmap TaskRepository::slotsByCompleted(bool completed) const
+{
+    return m_byCompleted[completed ? 1 : 0];
+}
+
+// Поиск подстроки без учета регистра
+// Кандидаты берутся из индекса n-грамм; для запросов короче триграммы
+// список индекса уже точный, длинные проверяются по названию в свернутом регистре
+SlotBitmap TaskRepository::slotsByTitle(const QString &keyword) const
+{
+    QString foldedKeyword = TrigramIndex::fold(keyword);
+    if (foldedKeyword.isEmpty()) {
+        return m_liveSlots;
+    }
+    
+    QVector<int> candidates = m_titleIndex.candidates(foldedKeyword);
+    if (foldedKeyword.size() < TrigramIndex::GRAM_SIZE) {
+        return SlotBitmap::fromSortedSlots(candidates);
+    }
+    QVector<int> matched;
+    for (int slot : candidates) {
+        if (CaseFoldSearch::containsFolded(m_tasks.at(slot)->getFoldedTitle(), foldedKeyword)) {
+            matched.append(slot);
+        }
+    }
+    return SlotBitmap::fromSortedSlots(matched);
+}
+
+// Запрос без слов, как и пустая подстрока, подходит под любое название
+SlotBitmap TaskRepository::slotsByFuzzyTitle(const QString &keyword) const
+{
+    if (FullTextIndex::tokenize(keyword).isEmpty()) {
+        return m_liveSlots;
+    }
+    return m_fuzzyIndex.search(keyword);
+}
+
+// Частота названия - число задач с таким названием
+QStringList TaskRepository::completeTitle(const QString &prefix, int limit) const
+{
+    return m_titleCompletion.complete(TrigramIndex::fold(prefix), limit);
+}
+
+QList<QList<Task*>> TaskRepository::nearDuplicateClusters(double threshold) const
+{
+    QList<QList<Task*>> result;
+    for (const QVector<int> &cluster : m_duplicates.clusters(threshold)) {
+        QList<Task*> tasks;
+        for (int slot : cluster) {
+            tasks.append(m_tasks.at(slot));
+        }
+        result.append(tasks);
+    }
+    return result;
+}
+
+QList<Task*> TaskRepository::findNearDuplicates(const QString &title, double threshold) const
+{
+    QList<Task*> result;
+    for (int slot : m_duplicates.similarTo(title, threshold)) {
+        result.append(m_tasks.at(slot));
+    }
+    return result;
+}
+
+// Задачи с дедлайном в указанный день
+SlotBitmap TaskRepository::slotsByDeadlineDay(const QDate &day) const
+{
+    SlotBitmap result;
+    if (!day.isValid()) {
+        return result;
+    }
+    
+    qint64 fromMs;
+    qint64 toMs;
+    deadlineDayBounds(day, fromMs, toMs);
+    for (int completed = 0; completed < 2; ++completed) {
+        DeadlineIndex::const_iterator it = deadlineLowerBound(completed != 0, fromMs);
+        DeadlineIndex::const_iterator end = deadlineLowerBound(completed != 0, toMs);
+        for (; it != end; ++it) {
+            if (it.value()->getDeadline().date() == day) {
+                result.insert(it.key().slot);
+            }
+        }
+    }
+    return result;
+}
+
+int TaskRepository::estimateTitleMatches(const QString &keyword) const
+{
+    QString foldedKeyword = TrigramIndex::fold(keyword);
+    if (foldedKeyword.isEmpty()) {
+        return m_tasks.size();
+    }
+    return m_titleIndex.estimate(foldedKeyword);
+}
+
+int TaskRepository::estimateFuzzyTitleMatches(const QString &keyword) const
+{
+    if (FullTextIndex::tokenize(keyword).isEmpty()) {
+        return m_tasks.size();
+    }
+    return qMin(m_fuzzyIndex.estimate(keyword), m_tasks.size());
+}
+
+// Число ключей индекса в окрестности дня; подсчет обрывается на DEADLINE_ESTIMATE_LIMIT,
+// чтобы оценка не стоила столько же, сколько сама выборка
+int TaskRepository::estimateDeadlineDay(const QDate &day) const
+{
+    if (!day.isValid()) {
+        return 0;
+    }
+    
+    qint64 fromMs;
+    qint64 toMs;
+    deadlineDayBounds(day, fromMs, toMs);
+    int count = 0;
+    for (int completed = 0; completed < 2; ++completed) {
+        DeadlineIndex::const_iterator it = deadlineLowerBound(completed != 0, fromMs);
+        DeadlineIndex::const_iterator end = deadlineLowerBound(completed != 0, toMs);
+        for (; it != end && count < DEADLINE_ESTIMATE_LIMIT; ++it) {
+            ++count;
+        }
+    }
+    return count < DEADLINE_ESTIMATE_LIMIT ? count : m_tasks.size();
+}
+
+// Границы выборки для дня дедлайна: с запасом в сутки с каждой стороны
+// (дедлайны могут быть в другом часовом поясе), точная дата проверяется по кандидатам
+void TaskRepository::deadlineDayBounds(const QDate &day, qint64 &fromMs, qint64 &toMs)
+{
+    QDateTime dayStart(day, QTime(0, 0));
+    fromMs = dayStart.addDays(-1).toMSecsSinceEpoch();
+    toMs = dayStart.addDays(2).toMSecsSinceEpoch();
+}
+
+// Границы полуинтервала [from, to) в мс; недействительная граница - без ограничения
+void TaskRepository::deadlineRangeBounds(const QDateTime &from, const QDateTime &to,
+                                         qint64 &fromMs, qint64 &toMs)
+{
+    fromMs = from.isValid() ? from.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+    toMs = to.isValid() ? to.toMSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+}
+
+SlotBitmap TaskRepository::slotsByDeadlineRange(const QDateTime &from, const QDateTime &to) const
+{
+    SlotBitmap result;
+    qint64 fromMs;
+    qint64 toMs;
+    deadlineRangeBounds(from, to, fromMs, toMs);
+    if (fromMs >= toMs) {
+        return result;
+    }
+    for (int completed = 0; completed < 2; ++completed) {
+        DeadlineIndex::const_iterator it = deadlineLowerBound(completed != 0, fromMs);
+        DeadlineIndex::const_iterator end = deadlineLowerBound(completed != 0, toMs);
+        for (; it != end; ++it) {
+            result.insert(it.key().slot);
+        }
+    }
+    return result;
+}
+
+// Как и для дня, считаем не дальше DEADLINE_ESTIMATE_LIMIT: широкий диапазон
+// все равно не станет путем доступа
+int TaskRepository::estimateDeadlineRange(const QDateTime &from, const QDateTime &to) const
+{
+    qint64 fromMs;
+    qint64 toMs;
+    deadlineRangeBounds(from, to, fromMs, toMs);
+    if (fromMs >= toMs) {
+        return 0;
+    }
+    int count = 0;
+    for (int completed = 0; completed < 2; ++completed) {
+        DeadlineIndex::const_iterator it = deadlineLowerBound(completed != 0, fromMs);
+        DeadlineIndex::const_iterator end = deadlineLowerBound(completed != 0, toMs);
+        for (; it != end && count < DEADLINE_ESTIMATE_LIMIT; ++it) {
+            ++count;
+        }
+    }
+    return count < DEADLINE_ESTIMATE_LIMIT ? count : m_tasks.size();
+}
+
+// Превращает битовую карту слотов в список задач в порядке добавления
+QList<Task*> TaskRepository::materialize(const SlotBitmap &slotSet) const
 {
     QList<Task*> result;
-    QString lowerKeyword = keyword.toLower();
-    for (Task *task : m_tasks) {
-        if (task->getTitle().toLower().contains(lowerKeyword)) {
-            result.append(task);
+    result.reserve(slotSet.count());
+    slotSet.forEach([this, &result](int slot) {
+        result.append(m_tasks.at(slot));
+    });
+    return result;
+}
+
+// Диапазон по индексу дедлайнов: два поддиапазона (активные и завершенные)
+// сливаются по дедлайну, что дает O(log n + k)
+QList<Task*> TaskRepository::findByDeadlineRange(const QDateTime &from, const QDateTime &to,
+                                                 bool activeOnly) const
+{
+    qint64 fromMs;
+    qint64 toMs;
+    deadlineRangeBounds(from, to, fromMs, toMs);
+    if (fromMs >= toMs) {
+        return QList<Task*>();
+    }
+    
+    DeadlineIndex::const_iterator end = m_byDeadline.constEnd();
+    return mergeByDeadline(deadlineLowerBound(false, fromMs), deadlineLowerBound(false, toMs),
+                           activeOnly ? end : deadlineLowerBound(true, fromMs),
+                           activeOnly ? end : deadlineLowerBound(true, toMs),
+                           std::numeric_limits<int>::max());
+}
+
+QList<Task*> TaskRepository::findNextDue(const QDateTime &from, int limit, bool activeOnly) const
+{
+    qint64 fromMs = from.isValid() ? from.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+    if (limit <= 0) {
+        return QList<Task*>();
+    }
+    
+    // Активные задачи занимают начало индекса - до первого ключа завершенных
+    DeadlineIndex::const_iterator end = m_byDeadline.constEnd();
+    DeadlineIndex::const_iterator activeEnd = deadlineLowerBound(true, std::numeric_limits<qint64>::min());
+    return mergeByDeadline(deadlineLowerBound(false, fromMs), activeEnd,
+                           activeOnly ? end : deadlineLowerBound(true, fromMs), end,
+                           limit);
+}
+
+// Последний ключ счетчика - наибольшее упреждение, O(1) вместо обхода задач
+int TaskRepository::maxReminderMinutes() const
+{
+    return m_reminderLeads.isEmpty() ? 0 : m_reminderLeads.lastKey();
+}
+
+bool TaskRepository::DeadlineKey::operator<(const DeadlineKey &other) const
+{
+    if (completed != other.completed) {
+        return !completed;
+    }
+    if (deadline != other.deadline) {
+        return deadline < other.deadline;
+    }
+    return slot < other.slot;
+}
+
+// Первый ключ индекса, не меньший (completed, deadline)
+TaskRepository::DeadlineIndex::const_iterator TaskRepository::deadlineLowerBound(bool completed, qint64 deadline) const
+{
+    DeadlineKey key = { completed, deadline, std::numeric_limits<int>::min() };
+    return m_byDeadline.lowerBound(key);
+}
+
+// Слияние двух отсортированных диапазонов индекса (активные и завершенные задачи)
+QList<Task*> TaskRepository::mergeByDeadline(DeadlineIndex::const_iterator active,
+                                             DeadlineIndex::const_iterator activeEnd,
+                                             DeadlineIndex::const_iterator done,
+                                             DeadlineIndex::const_iterator doneEnd,
+                                             int limit) const
+{
+    QList<Task*> result;
+    while (result.size() < limit && (active != activeEnd || done != doneEnd)) {
+        bool takeActive = done == doneEnd ||
+            (active != activeEnd && (active.key().deadline < done.key().deadline ||
+                                     (active.key().deadline == done.key().deadline &&
+                                      active.key().slot < done.key().slot)));
+        if (takeActive) {
+            result.append(active.value());
+            ++active;
+        } else {
+            result.append(done.value());
+            ++done;
         }
     }
     return result;
 }
 
+void TaskRepository::indexTask(int slot, Task *task)
+{
+    if (m_fields.size() <= slot) {
+        m_fields.resize(slot + 1);
+    }
+    indexAttributes(slot, task);
+    indexTitle(slot, task);
+    indexText(slot, task);
+}
+
+void TaskRepository::unindexTask(int slot, Task *task)
+{
+    unindexAttributes(slot);
+    unindexTitle(slot, task);
+    unindexText(slot);
+}
 
+void TaskRepository::indexAttributes(int slot, Task *task)
+{
+    IndexedFields &fields = m_fields[slot];
+    fields.owner = task->getOwner();
+    fields.project = task->getProject();
+    fields.priority = task->getPriority();
+    fields.completed = task->isCompleted();
+    fields.hasDeadline = task->getDeadline().isValid();
+    fields.deadline = fields.hasDeadline ? task->getDeadline().toMSecsSinceEpoch() : 0;
+    fields.reminderMinutes = task->getReminderMinutes();
+    
+    m_liveSlots.insert(slot);
+    m_byOwner[fields.owner].insert(slot);
+    m_byProject[fields.project].insert(slot);
+    m_byPriority[static_cast<int>(fields.priority)].insert(slot);
+    m_byCompleted[fields.completed ? 1 : 0].insert(slot);
+    if (fields.hasDeadline) {
+        DeadlineKey key = { fields.completed, fields.deadline, slot };
+        m_byDeadline.insert(key, task);
+        if (!fields.completed) {
+            ++m_reminderLeads[fields.reminderMinutes];
+        }
+    }
+}
+
+void TaskRepository::unindexAttributes(int slot)
+{
+    const IndexedFields &fields = m_fields.at(slot);
+    
+    m_liveSlots.remove(slot);
+    
+    // Пустые карты удаляем, чтобы индекс не рос от удаленных владельцев и проектов
+    QHash<User*, SlotBitmap>::iterator ownerIt = m_byOwner.find(fields.owner);
+    if (ownerIt != m_byOwner.end()) {
+        ownerIt->remove(slot);
+        if (ownerIt->isEmpty()) {
+            m_byOwner.erase(ownerIt);
+        }
+    }
+    QHash<Project*, SlotBitmap>::iterator projectIt = m_byProject.find(fields.project);
+    if (projectIt != m_byProject.end()) {
+        projectIt->remove(slot);
+        if (projectIt->isEmpty()) {
+            m_byProject.erase(projectIt);
+        }
+    }
+    m_byPriority[static_cast<int>(fields.priority)].remove(slot);
+    m_byCompleted[fields.completed ? 1 : 0].remove(slot);
+    if (fields.hasDeadline) {
+        DeadlineKey key = { fields.completed, fields.deadline, slot };
+        m_byDeadline.remove(key);
+        if (!fields.completed) {
+            QMap<int, int>::iterator leadIt = m_reminderLeads.find(fields.reminderMinutes);
+            if (leadIt != m_reminderLeads.end() && --leadIt.value() == 0) {
+                m_reminderLeads.erase(leadIt);
+            }
+        }
+    }
+}
 
+void TaskRepository::indexTitle(int slot, Task *task)
+{
+    const QString title = task->getTitle();
+    m_titleIndex.insert(slot, task->getFoldedTitle());
+    m_fuzzyIndex.insert(slot, title);
+    m_titleCompletion.insert(task->getFoldedTitle(), title);
+    m_duplicates.insert(slot, title);
+}
+
+// Вызывается, пока у задачи еще старое название (см. onTaskAboutToChange)
+void TaskRepository::unindexTitle(int slot, Task *task)
+{
+    m_titleIndex.remove(slot, task->getFoldedTitle());
+    m_fuzzyIndex.remove(slot, task->getTitle());
+    m_titleCompletion.remove(task->getFoldedTitle());
+    m_duplicates.remove(slot);
+}
+
+// Полнотекстовый индекс сам помнит слова документа, копия описания не нужна
+void TaskRepository::indexText(int slot, Task *task)
+{
+    m_textIndex.insert(slot, task->getTitle(), task->getDescription());
+}
+
+void TaskRepository::unindexText(int slot)
+{
+    m_textIndex.remove(slot);
+}
+
+QList<Task*> TaskRepository::searchFullText(const QString &query, int limit, QList<double> *scores) const
+{
+    QList<Task*> result;
+    for (const FullTextIndex::Hit &hit : m_textIndex.search(query, limit)) {
+        result.append(m_tasks.at(hit.slot));
+        if (scores) {
+            scores->append(hit.score);
+        }
+    }
+    return result;
+}
+
+void TaskRepository::rebuildIndexes()
+{
+    m_fields.clear();
+    m_liveSlots.clear();
+    m_byOwner.clear();
+    m_byProject.clear();
+    m_byPriority.clear();
+    m_byCompleted[0].clear();
+    m_byCompleted[1].clear();
+    m_byDeadline.clear();
+    m_reminderLeads.clear();
+    m_titleIndex.clear();
+    m_fuzzyIndex.clear();
+    m_titleCompletion.clear();
+    m_duplicates.clear();
+    m_textIndex.clear();
+    
+    m_fields.resize(m_tasks.slotCount());
+    for (int slot = 0; slot < m_tasks.slotCount(); ++slot) {
+        Task *task = m_tasks.at(slot);
+        if (task) {
+            indexTask(slot, task);
+        }
+    }
+}
+
+// Уплотнение меняет номера слотов, но не их порядок: индексы переносятся
+// на новую нумерацию без повторного разбора названий и описаний.
+// Словарь дополнений хранит строки, а не слоты, и не меняется
+void TaskRepository::compact()
+{
+    const QVector<int> slots = m_tasks.compact();
+    auto remapBitmap = [&slots](SlotBitmap &bitmap) {
+        QVector<int> list = bitmap.toVector();
+        remapSlots(list, slots);
+        bitmap = SlotBitmap::fromSortedSlots(list);
+    };
+
+    QVector<IndexedFields> fields(m_tasks.slotCount());
+    for (int slot = 0; slot < slots.size() && slot < m_fields.size(); ++slot) {
+        if (slots.at(slot) >= 0) {
+            fields[slots.at(slot)] = m_fields.at(slot);
+        }
+    }
+    m_fields = fields;
+    remapBitmap(m_liveSlots);
+    for (SlotBitmap &bitmap : m_byOwner) {
+        remapBitmap(bitmap);
+    }
+    for (SlotBitmap &bitmap : m_byProject) {
+        remapBitmap(bitmap);
+    }
+    for (SlotBitmap &bitmap : m_byPriority) {
+        remapBitmap(bitmap);
+    }
+    remapBitmap(m_byCompleted[0]);
+    remapBitmap(m_byCompleted[1]);
+
+    // Порядок ключей сохраняется, поэтому вставка идет в конец без поиска места
+    DeadlineIndex deadlines;
+    for (DeadlineIndex::const_iterator it = m_byDeadline.constBegin(); it != m_byDeadline.constEnd(); ++it) {
+        DeadlineKey key = it.key();
+        key.slot = slots.at(key.slot);
+        deadlines.insert(deadlines.constEnd(), key, it.value());
+    }
+    m_byDeadline = deadlines;
+
+    m_titleIndex.remap(slots);
+    m_fuzzyIndex.remap(slots);
+    m_duplicates.remap(slots);
+    m_textIndex.remap(slots);
+}
+
+// Убирает задачу из индексов названия до смены названия: триграммы, нечеткий
+// индекс и словарь дополнений удаляются по старому тексту
+void TaskRepository::onTaskAboutToChange(Task *task, Task::Fields changing)
+{
+    int slot = m_tasks.slotOf(task);
+    if (slot >= 0 && (changing & Task::TitleField)) {
+        unindexTitle(slot, task);
+    }
+}
+
+// Переиндексирует задачу после изменения ее полей
+// Маска полей из уведомления говорит, какие индексы затронуты
+void TaskRepository::onTaskChanged(Task *task, Task::Fields changed)
+{
+    int slot = m_tasks.slotOf(task);
+    if (slot < 0) {
+        return;
+    }
+    
+    const Task::Fields attributes = Task::OwnerField | Task::ProjectField | Task::PriorityField |
+                                    Task::CompletedField | Task::DeadlineField | Task::ReminderField;
+    if (changed & attributes) {
+        unindexAttributes(slot);
+        indexAttributes(slot, task);
+    }
+    // Триграммы пересчитываются только при смене названия, полнотекстовый индекс -
+    // при смене названия или описания
+    bool titleChanged = changed & Task::TitleField;
+    bool textChanged = changed & (Task::TitleField | Task::DescriptionField);
+    if (titleChanged) {
+        indexTitle(slot, task); // старое название снято в onTaskAboutToChange
+    }
+    if (textChanged) {
+        unindexText(slot);
+        indexText(slot, task);
+    }
+    
+    ++m_generation;
+    emit taskUpdated(task);
+}
@@ -2,9 +2,26 @@
 #define TASKREPOSITORY_H
 
 #include "repositories.h"
+#include "slotstore.h"
+#include "trigramindex.h"
+#include "fulltextindex.h"
+#include "fuzzyindex.h"
+#include "completionindex.h"
+#include "duplicateindex.h"
+#include "../models/taskchangedispatcher.h"
 #include <QObject>
+#include <QMap>
+#include <QHash>
+#include <QVector>
 
-// Реализация репозитория задач - хранит задачи в памяти (QList)
+// Реализация репозитория задач - хранит задачи в памяти (SlotStore)
+// Поддерживает индексы:
+// - вторичные по владельцу, проекту, приоритету и статусу;
+// - упорядоченный индекс дедлайнов и счетчики упреждений напоминаний;
+// - по названиям: триграммы, словарь слов для нечеткого поиска,
+//   дополнение по префиксу и подписи MinHash для поиска дубликатов;
+// - полнотекстовый по названиям и описаниям.
+// Индексы обновляются инкрементально по уведомлениям TaskChangeDispatcher
 // Эмитирует сигналы при изменениях для уведомления подписчиков
 class TaskRepository : public QObject, public ITaskRepository
 {
@@ -16,15 +33,50 @@ public:
     // IRepository interface
     void add(Task *task) override;
     void remove(Task *task) override;
-    QList<Task*> getAll() const override { return m_tasks; }
+    QList<Task*> getAll() const override { return m_tasks.items(); }
     Task* findById(int id) const override;
     void clear() override;
     
     // ITaskRepository interface
     QList<Task*> searchByTitle(const QString &keyword) const override;
+    quint64 generation() const override { return m_generation; }
+    QList<Task*> findByOwner(User *owner) const override;
+    QList<Task*> findByProject(Project *project) const override;
+    QList<Task*> findByPriority(Priority priority) const override;
+    QList<Task*> findByCompleted(bool completed) const override;
+    QList<Task*> findByDeadlineRange(const QDateTime &from, const QDateTime &to,
+                                     bool activeOnly = false) const override;
+    QList<Task*> findNextDue(const QDateTime &from, int limit,
+                             bool activeOnly = true) const override;
+    int maxReminderMinutes() const override;
+    SlotBitmap allSlots() const override { return m_liveSlots; }
+    SlotBitmap slotsByOwner(User *owner) const override;
+    SlotBitmap slotsByProject(Project *project) const override;
+    SlotBitmap slotsByPriority(Priority priority) const override;
+    SlotBitmap slotsByCompleted(bool completed) const override;
+    SlotBitmap slotsByTitle(const QString &keyword) const override;
+    SlotBitmap slotsByFuzzyTitle(const QString &keyword) const override;
+    SlotBitmap slotsByDeadlineDay(const QDate &day) const override;
+    SlotBitmap slotsByDeadlineRange(const QDateTime &from, const QDateTime &to) const override;
+    QList<Task*> materialize(const SlotBitmap &slotSet) const override;
+    int slotCount() const override { return m_tasks.slotCount(); }
+    Task* atSlot(int slot) const override { return m_tasks.at(slot); }
+    QList<Task*> searchFullText(const QString &query, int limit,
+                                QList<double> *scores = nullptr) const override;
+    QStringList completeTitle(const QString &prefix, int limit) const override;
+    QList<QList<Task*>> nearDuplicateClusters(double threshold) const override;
+    QList<Task*> findNearDuplicates(const QString &title, double threshold) const override;
+    int estimateTitleMatches(const QString &keyword) const override;
+    int estimateFuzzyTitleMatches(const QString &keyword) const override;
+    int estimateDeadlineDay(const QDate &day) const override;
+    int estimateDeadlineRange(const QDateTime &from, const QDateTime &to) const override;
     
     int getNextId() { return m_nextTaskId++; }
     void setNextId(int id) { m_nextTaskId = id; }
+    
+    // Диспетчер изменений задач репозитория: сигнал taskChanged(ID, маска полей)
+    // приходит после обновления индексов
+    TaskChangeDispatcher* changeDispatcher() { return &m_dispatcher; }
 
 signals:
     void taskAdded(Task *task);
@@ -32,11 +84,75 @@ signals:
     void taskUpdated(Task *task);
 
 private:
-    QList<Task*> m_tasks;
+    static const int DEADLINE_ESTIMATE_LIMIT = 4096;
+    
+    // Значения индексируемых полей на момент последней индексации
+    // Нужны, чтобы при изменении задачи убрать ее из старых списков.
+    // Название здесь не копируется: перед его сменой задача сообщает
+    // aboutToChange, и индексы названия чистятся по еще старому значению
+    struct IndexedFields {
+        User *owner;
+        Project *project;
+        Priority priority;
+        bool completed;
+        bool hasDeadline;
+        qint64 deadline; // мс с начала эпохи
+        int reminderMinutes;
+    };
+    
+    // Ключ индекса дедлайнов. Статус стоит первым, чтобы активные задачи
+    // образовывали непрерывный диапазон; слот делает ключ уникальным
+    // и упорядочивает задачи с одинаковым дедлайном по времени добавления
+    struct DeadlineKey {
+        bool completed;
+        qint64 deadline;
+        int slot;
+        bool operator<(const DeadlineKey &other) const;
+    };
+    typedef QMap<DeadlineKey, Task*> DeadlineIndex;
+    
+    void indexTask(int slot, Task *task);
+    void unindexTask(int slot, Task *task);
+    void indexAttributes(int slot, Task *task);
+    void unindexAttributes(int slot);
+    void indexTitle(int slot, Task *task);
+    void unindexTitle(int slot, Task *task);
+    void indexText(int slot, Task *task);
+    void unindexText(int slot);
+    void rebuildIndexes();
+    void compact();
+    void onTaskAboutToChange(Task *task, Task::Fields changing);
+    void onTaskChanged(Task *task, Task::Fields changed);
+    DeadlineIndex::const_iterator deadlineLowerBound(bool completed, qint64 deadline) const;
+    static void deadlineDayBounds(const QDate &day, qint64 &fromMs, qint64 &toMs);
+    static void deadlineRangeBounds(const QDateTime &from, const QDateTime &to, qint64 &fromMs, qint64 &toMs);
+    QList<Task*> mergeByDeadline(DeadlineIndex::const_iterator active,
+                                 DeadlineIndex::const_iterator activeEnd,
+                                 DeadlineIndex::const_iterator done,
+                                 DeadlineIndex::const_iterator doneEnd,
+                                 int limit) const;
+    
+    SlotStore<Task> m_tasks;
+    TaskChangeDispatcher m_dispatcher;
     int m_nextTaskId;
+    quint64 m_generation;
+    
+    // Вторичные индексы: значение поля -> битовая карта слотов задач
+    QVector<IndexedFields> m_fields;
+    SlotBitmap m_liveSlots;
+    QHash<User*, SlotBitmap> m_byOwner;
+    QHash<Project*, SlotBitmap> m_byProject;
+    QHash<int, SlotBitmap> m_byPriority;
+    SlotBitmap m_byCompleted[2];
+    // Упорядоченный индекс дедлайнов (задачи без дедлайна в него не попадают)
+    DeadlineIndex m_byDeadline;
+    // Упреждение напоминания -> число незавершенных задач с дедлайном и таким упреждением
+    QMap<int, int> m_reminderLeads;
+    TrigramIndex m_titleIndex;
+    FuzzyTitleIndex m_fuzzyIndex;
+    CompletionIndex m_titleCompletion;
+    DuplicateIndex m_duplicates;
+    FullTextIndex m_textIndex;
 };
 
 #endif // TASKREPOSITORY_H
-
-
-
@@ -3,18 +3,40 @@
 #include "userrepository.h"
 #include "projectrepository.h"
 #include "strategies.h"
+#include "queryplanner.h"
+#include "querycompiler.h"
+#include "casefoldsearch.h"
+#include "tasksortkey.h"
+#include "jsonarrayreader.h"
 #include "../models/task.h"
 #include "../models/user.h"
 #include "../models/project.h"
 #include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QPair>
 #include <QJsonArray>
 #include <QJsonValue>
 #include <QJsonDocument>
 #include <QDateTime>
+#include <QTime>
 #include <QFile>
 #include <QIODevice>
+#include <QDataStream>
 #include <QCoreApplication>
+#include <QThread>
 #include <algorithm>
+#include <limits>
+
+namespace {
+
+// Скомпилированный текстовый запрос как лист составного предиката TaskFilter
+struct QueryMatches {
+    QSharedPointer<const CompiledQuery> query;
+    bool operator()(Task *task) const { return !query || query->matches(task); }
+};
+
+}
 
 TaskService::TaskService(ITaskRepository *taskRepo, 
                          IUserRepository *userRepo,
@@ -23,7 +45,10 @@ TaskService::TaskService(ITaskRepository *taskRepo,
     : QObject(parent),
       m_taskRepository(taskRepo),
       m_userRepository(userRepo),
-      m_projectRepository(projectRepo)
+      m_projectRepository(projectRepo),
+      m_compiledQueries(COMPILED_QUERY_CACHE_SIZE),
+      m_catalogGeneration(0),
+      m_parallelThreshold(DEFAULT_PARALLEL_THRESHOLD)
 {
     // Пробрасываем сигналы из репозитория для уведомления подписчиков (UI, ReminderManager)
     TaskRepository *repo = dynamic_cast<TaskRepository*>(taskRepo);
@@ -31,6 +56,7 @@ TaskService::TaskService(ITaskRepository *taskRepo,
         connect(repo, &TaskRepository::taskAdded, this, &TaskService::taskAdded);
         connect(repo, &TaskRepository::taskRemoved, this, &TaskService::taskRemoved);
         connect(repo, &TaskRepository::taskUpdated, this, &TaskService::taskUpdated);
+        connect(repo->changeDispatcher(), &TaskChangeDispatcher::taskChanged, this, &TaskService::taskFieldsChanged);
     }
 }
 
@@ -53,10 +79,42 @@ QList<Task*> TaskService::getAllTasks() const
     return m_taskRepository ? m_taskRepository->getAll() : QList<Task*>();
 }
 
+Task* TaskService::findTaskById(int id) const
+{
+    return m_taskRepository ? m_taskRepository->findById(id) : nullptr;
+}
+
+// Обход слотов репозитория по одному - без копии списка всех задач
+TaskStream<Task*> TaskService::stream() const
+{
+    const ITaskRepository *repo = m_taskRepository;
+    int slot = 0;
+    return TaskStream<Task*>([repo, slot](Task *&task) mutable -> bool {
+        if (!repo) {
+            return false;
+        }
+        while (slot < repo->slotCount()) {
+            task = repo->atSlot(slot++);
+            if (task) {
+                return true;
+            }
+        }
+        return false;
+    });
+}
+
+// Текстовый запрос компилируется один раз на поток, а не на каждую задачу
+TaskStream<Task*> TaskService::stream(const FilterOptions &filterOpts) const
+{
+    QueryMatches queryMatches = { compiledQuery(filterOpts) };
+    return stream().filter(TaskFilter::all(optionsFilter(filterOpts), queryMatches));
+}
+
 void TaskService::addUser(User *user)
 {
     if (m_userRepository) {
         m_userRepository->add(user);
+        catalogModified();
     }
 }
 
@@ -64,6 +122,7 @@ void TaskService::removeUser(User *user)
 {
     if (m_userRepository) {
         m_userRepository->remove(user);
+        catalogModified();
     }
 }
 
@@ -82,10 +141,20 @@ User* TaskService::findUserByName(const QString &name) const
     return m_userRepository ? m_userRepository->findByName(name) : nullptr;
 }
 
+void TaskService::renameUser(User *user, const QString &name)
+{
+    if (m_userRepository) {
+        m_userRepository->rename(user, name);
+        catalogModified();
+        emit catalogChanged();
+    }
+}
+
 void TaskService::addProject(Project *project)
 {
     if (m_projectRepository) {
         m_projectRepository->add(project);
+        catalogModified();
     }
 }
 
@@ -93,6 +162,7 @@ void TaskService::removeProject(Project *project)
 {
     if (m_projectRepository) {
         m_projectRepository->remove(project);
+        catalogModified();
     }
 }
 
@@ -111,64 +181,133 @@ Project* TaskService::findProjectByName(const QString &name) const
     return m_projectRepository ? m_projectRepository->findByName(name) : nullptr;
 }
 
-// Применяет несколько фильтров последовательно (пересечение результатов)
+void TaskService::renameProject(Project *project, const QString &name)
+{
+    if (m_projectRepository) {
+        m_projectRepository->rename(project, name);
+        // Название проекта участвует в сортировке и в текстовых запросах
+        catalogModified();
+        emit catalogChanged();
+    }
+}
+
+// Текстовые запросы ссылаются на пользователей и проекты по имени: после изменения
+// справочников и скомпилированные запросы, и результаты по ним устарели
+void TaskService::catalogModified()
+{
+    ++m_catalogGeneration;
+    m_queryCache.clear();
+}
+
+// Применяет несколько фильтров (пересечение результатов)
+// Каждая стратегия сужает результат предыдущей; стратегии-предикаты делают это
+// одним проходом с matches(). Условия, известные при компиляции, дешевле передать
+// составным предикатом TaskFilter в шаблонную перегрузку
 QList<Task*> TaskService::filterTasks(const QList<IFilterStrategy*> &filters) const
 {
-    QList<Task*> tasks = getAllTasks();
-    
-    // Каждая стратегия фильтрует результат предыдущей
-    for (IFilterStrategy *filter : filters) {
+    QList<Task*> result = getAllTasks();
+    for (const IFilterStrategy *filter : filters) {
         if (filter) {
-            tasks = filter->filter(tasks);
+            result = filter->filter(result);
         }
     }
-    
-    return tasks;
+    return result;
 }
 
+// Простые фильтры читают готовые выборки из вторичных индексов репозитория,
+// не просматривая все задачи
 QList<Task*> TaskService::filterByPriority(Priority priority) const
 {
-    PriorityFilterStrategy strategy(priority);
-    QList<IFilterStrategy*> filters;
-    filters.append(&strategy);
-    return filterTasks(filters);
+    return m_taskRepository ? m_taskRepository->findByPriority(priority) : QList<Task*>();
 }
 
+// Фильтр по дню дедлайна через индекс дедлайнов
 QList<Task*> TaskService::filterByDate(const QDateTime &date) const
 {
-    DateFilterStrategy strategy(date);
-    QList<IFilterStrategy*> filters;
-    filters.append(&strategy);
-    return filterTasks(filters);
+    if (!m_taskRepository || !date.isValid()) {
+        return QList<Task*>();
+    }
+    return m_taskRepository->materialize(m_taskRepository->slotsByDeadlineDay(date.date()));
 }
 
 QList<Task*> TaskService::filterByProject(Project *project) const
 {
-    ProjectFilterStrategy strategy(project);
-    QList<IFilterStrategy*> filters;
-    filters.append(&strategy);
-    return filterTasks(filters);
+    return m_taskRepository ? m_taskRepository->findByProject(project) : QList<Task*>();
 }
 
 QList<Task*> TaskService::filterByUser(User *user) const
 {
-    UserFilterStrategy strategy(user);
-    QList<IFilterStrategy*> filters;
-    filters.append(&strategy);
-    return filterTasks(filters);
+    return m_taskRepository ? m_taskRepository->findByOwner(user) : QList<Task*>();
 }
 
 QList<Task*> TaskService::filterCompleted(bool completed) const
 {
-    CompletedFilterStrategy strategy(completed);
-    QList<IFilterStrategy*> filters;
-    filters.append(&strategy);
-    return filterTasks(filters);
+    return m_taskRepository ? m_taskRepository->findByCompleted(completed) : QList<Task*>();
+}
+
+QList<Task*> TaskService::searchByTitle(const QString &keyword, bool fuzzy) const
+{
+    if (!m_taskRepository) {
+        return QList<Task*>();
+    }
+    if (fuzzy) {
+        return m_taskRepository->materialize(m_taskRepository->slotsByFuzzyTitle(keyword));
+    }
+    return m_taskRepository->searchByTitle(keyword);
+}
+
+QList<Task*> TaskService::searchFullText(const QString &query, int limit) const
+{
+    return m_taskRepository ? m_taskRepository->searchFullText(query, limit) : QList<Task*>();
+}
+
+QStringList TaskService::completeTitle(const QString &prefix, int limit) const
+{
+    return m_taskRepository ? m_taskRepository->completeTitle(prefix, limit) : QStringList();
 }
 
-QList<Task*> TaskService::searchByTitle(const QString &keyword) const
+QStringList TaskService::completeUserName(const QString &prefix, int limit) const
 {
-    return m_taskRepository ? m_taskRepository->searchByTitle(keyword) : QList<Task*>();
+    return m_userRepository ? m_userRepository->completeName(prefix, limit) : QStringList();
+}
+
+QStringList TaskService::completeProjectName(const QString &prefix, int limit) const
+{
+    return m_projectRepository ? m_projectRepository->completeName(prefix, limit) : QStringList();
+}
+
+QList<QList<Task*>> TaskService::findNearDuplicateClusters(double threshold) const
+{
+    return m_taskRepository ? m_taskRepository->nearDuplicateClusters(threshold) : QList<QList<Task*>>();
+}
+
+QList<Task*> TaskService::findNearDuplicates(const QString &title, double threshold) const
+{
+    return m_taskRepository ? m_taskRepository->findNearDuplicates(title, threshold) : QList<Task*>();
+}
+
+QList<Task*> TaskService::getTasksDueBetween(const QDateTime &from, const QDateTime &to,
+                                            bool activeOnly) const
+{
+    return m_taskRepository ? m_taskRepository->findByDeadlineRange(from, to, activeOnly)
+                            : QList<Task*>();
+}
+
+QList<Task*> TaskService::getNextDueTasks(int count, const QDateTime &from) const
+{
+    QDateTime start = from.isValid() ? from : QDateTime::currentDateTime();
+    return m_taskRepository ? m_taskRepository->findNextDue(start, count, true) : QList<Task*>();
+}
+
+QList<Task*> TaskService::getOverdueTasks(const QDateTime &now) const
+{
+    QDateTime current = now.isValid() ? now : QDateTime::currentDateTime();
+    return getTasksDueBetween(QDateTime(), current, true);
+}
+
+int TaskService::getMaxReminderMinutes() const
+{
+    return m_taskRepository ? m_taskRepository->maxReminderMinutes() : 0;
 }
 
 // Сериализация всех данных в JSON для сохранения
@@ -304,6 +443,26 @@ void TaskService::clearAll()
     if (m_taskRepository) m_taskRepository->clear();
     if (m_userRepository) m_userRepository->clear();
     if (m_projectRepository) m_projectRepository->clear();
+    catalogModified();
+    emit catalogChanged();
+}
+
+namespace {
+
+QJsonObject taskToJson(Task *task)
+{
+    QJsonObject obj;
+    obj["title"] = task->getTitle();
+    obj["description"] = task->getDescription();
+    obj["deadline"] = task->getDeadline().toString(Qt::ISODate);
+    obj["priority"] = Task::priorityToString(task->getPriority());
+    obj["completed"] = task->isCompleted();
+    obj["owner"] = task->getOwner() ? task->getOwner()->getName() : "";
+    obj["project"] = task->getProject() ? task->getProject()->getName() : "";
+    obj["reminderMinutes"] = task->getReminderMinutes();
+    return obj;
+}
+
 }
 
 // Экспорт задач в JSON массив (для импорта/экспорта файлов)
@@ -311,68 +470,91 @@ void TaskService::clearAll()
 QJsonArray TaskService::exportTasksToJsonArray() const
 {
     QJsonArray array;
-    for (Task *task : getAllTasks()) {
-        QJsonObject obj;
-        obj["title"] = task->getTitle();
-        obj["description"] = task->getDescription();
-        obj["deadline"] = task->getDeadline().toString(Qt::ISODate);
-        obj["priority"] = Task::priorityToString(task->getPriority());
-        obj["completed"] = task->isCompleted();
-        obj["owner"] = task->getOwner() ? task->getOwner()->getName() : "";
-        obj["project"] = task->getProject() ? task->getProject()->getName() : "";
-        obj["reminderMinutes"] = task->getReminderMinutes();
-        array.append(obj);
-    }
+    stream().forEach([&array](Task *task) { array.append(taskToJson(task)); });
     return array;
 }
 
-// Импорт задач из JSON массива
-// Автоматически создает пользователей и проекты если их нет
+namespace {
+
+// Ключ дубликата при импорте: владелец, название и дедлайн
+typedef QPair<User*, QPair<QString, qint64>> DuplicateKey;
+
+DuplicateKey duplicateKey(const QString &title, const QDateTime &deadline, User *owner)
+{
+    qint64 deadlineMs = deadline.isValid() ? deadline.toMSecsSinceEpoch()
+                                           : std::numeric_limits<qint64>::min();
+    return qMakePair(owner, qMakePair(title, deadlineMs));
+}
+
+}
+
+// Импорт задач из JSON объектов
+// Разобранные задачи и недостающие пользователи и проекты копятся в буфере
+// и попадают в репозитории только в commit(), поэтому ошибка в середине файла
+// ничего не меняет: несохраненное удаляет деструктор
 // Проверяет дубликаты если skipDuplicates = true
-int TaskService::importTasksFromJsonArray(const QJsonArray &array, bool skipDuplicates)
+class TaskService::JsonTaskImporter
 {
-    int imported = 0;
+public:
+    JsonTaskImporter(TaskService *service, bool skipDuplicates)
+        : m_service(service), m_skipDuplicates(skipDuplicates)
+    {
+        // Ключи существующих задач собираются один раз - проверка каждой строки за O(1)
+        if (m_skipDuplicates) {
+            m_service->stream().forEach([this](Task *task) {
+                m_existingKeys.insert(duplicateKey(task->getTitle(), task->getDeadline(), task->getOwner()));
+            });
+        }
+    }
     
-    for (const QJsonValue &value : array) {
-        QJsonObject obj = value.toObject();
+    ~JsonTaskImporter()
+    {
+        qDeleteAll(m_tasks);
+        qDeleteAll(m_newUsers);
+        qDeleteAll(m_newProjects);
+    }
+    
+    // true, если задача принята (не дубликат)
+    bool import(const QJsonObject &obj)
+    {
         QString title = obj["title"].toString();
         QDateTime deadline = QDateTime::fromString(obj["deadline"].toString(), Qt::ISODate);
         Priority priority = Task::stringToPriority(obj["priority"].toString());
         
         // Создаем пользователя если его нет
         QString ownerName = obj["owner"].toString();
-        User *owner = findUserByName(ownerName);
+        User *owner = m_service->findUserByName(ownerName);
+        if (!owner) {
+            owner = m_usersByName.value(ownerName);
+        }
         if (!owner) {
             owner = new User(ownerName);
-            addUser(owner);
+            m_newUsers.append(owner);
+            m_usersByName.insert(ownerName, owner);
         }
         
         // Создаем проект если его нет
         QString projectName = obj["project"].toString();
         Project *project = nullptr;
         if (!projectName.isEmpty()) {
-            project = findProjectByName(projectName);
+            project = m_service->findProjectByName(projectName);
+            if (!project) {
+                project = m_projectsByName.value(projectName);
+            }
             if (!project) {
                 project = new Project(projectName);
-                addProject(project);
+                m_newProjects.append(project);
+                m_projectsByName.insert(projectName, project);
             }
         }
         
         // Проверка дубликатов по названию, дедлайну и владельцу
-        if (skipDuplicates) {
-            bool isDuplicate = false;
-            QList<Task*> allTasks = getAllTasks();
-            for (Task *existingTask : allTasks) {
-                if (existingTask->getTitle() == title &&
-                    existingTask->getDeadline() == deadline &&
-                    existingTask->getOwner() == owner) {
-                    isDuplicate = true;
-                    break;
-                }
-            }
-            if (isDuplicate) {
-                continue;
+        if (m_skipDuplicates) {
+            DuplicateKey key = duplicateKey(title, deadline, owner);
+            if (m_existingKeys.contains(key)) {
+                return false;
             }
+            m_existingKeys.insert(key);
         }
         
         int reminderMinutes = obj["reminderMinutes"].toInt(60);
@@ -381,14 +563,53 @@ int TaskService::importTasksFromJsonArray(const QJsonArray &array, bool skipDupl
         task->setDescription(obj["description"].toString());
         task->setCompleted(obj["completed"].toBool());
         
-        addTask(task);
-        imported++;
+        m_tasks.append(task);
+        return true;
+    }
+    
+    // Передает накопленное в репозитории, возвращает число добавленных задач
+    int commit()
+    {
+        for (User *user : m_newUsers) {
+            m_service->addUser(user);
+        }
+        for (Project *project : m_newProjects) {
+            m_service->addProject(project);
+        }
+        for (Task *task : m_tasks) {
+            m_service->addTask(task);
+        }
+        int imported = m_tasks.size();
+        m_newUsers.clear();
+        m_newProjects.clear();
+        m_tasks.clear();
+        return imported;
     }
     
-    return imported;
+private:
+    TaskService *m_service;
+    bool m_skipDuplicates;
+    QSet<DuplicateKey> m_existingKeys;
+    QList<Task*> m_tasks;
+    QList<User*> m_newUsers;
+    QList<Project*> m_newProjects;
+    QHash<QString, User*> m_usersByName;
+    QHash<QString, Project*> m_projectsByName;
+};
+
+// Импорт задач из JSON массива
+int TaskService::importTasksFromJsonArray(const QJsonArray &array, bool skipDuplicates)
+{
+    JsonTaskImporter importer(this, skipDuplicates);
+    for (const QJsonValue &value : array) {
+        importer.import(value.toObject());
+    }
+    return importer.commit();
 }
 
 // Импорт задач из файла
+// Файл читается потоково по одному элементу массива, без загрузки всего JSON в память.
+// Импорт атомарный: задачи добавляются, только если массив прочитан до конца без ошибок
 int TaskService::importTasksFromFile(const QString &fileName, bool skipDuplicates)
 {
     QFile file(fileName);
@@ -396,148 +617,473 @@ int TaskService::importTasksFromFile(const QString &fileName, bool skipDuplicate
         return -1; // Ошибка открытия файла
     }
     
-    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    JsonArrayReader reader(&file);
+    JsonTaskImporter importer(this, skipDuplicates);
+    QJsonObject obj;
+    while (reader.next(obj)) {
+        importer.import(obj);
+    }
     file.close();
     
-    if (!doc.isArray()) {
-        return -1; // Неверный формат файла
+    if (reader.hasError()) {
+        return -1; // Неверный формат файла - ничего не добавлено
     }
-    
-    QJsonArray array = doc.array();
-    return importTasksFromJsonArray(array, skipDuplicates);
+    return importer.commit();
 }
 
 // Экспорт задач в файл
+// Задачи пишутся по одной, без промежуточного JSON массива всех задач
 bool TaskService::exportTasksToFile(const QString &fileName) const
 {
-    QJsonArray array = exportTasksToJsonArray();
-    
-    QJsonDocument doc(array);
     QFile file(fileName);
     if (!file.open(QIODevice::WriteOnly)) {
         return false; // Ошибка сохранения файла
     }
     
-    file.write(doc.toJson());
+    bool first = true;
+    file.write("[\n");
+    stream().forEach([&file, &first](Task *task) {
+        if (!first) {
+            file.write(",\n");
+        }
+        first = false;
+        file.write(QJsonDocument(taskToJson(task)).toJson(QJsonDocument::Compact));
+    });
+    file.write("\n]\n");
     file.close();
     
     return true;
 }
 
+bool TaskService::FilterOptions::operator==(const FilterOptions &other) const
+{
+    return searchText == other.searchText &&
+           query == other.query &&
+           fuzzySearch == other.fuzzySearch &&
+           priorityFilterEnabled == other.priorityFilterEnabled &&
+           (!priorityFilterEnabled || priorityFilter == other.priorityFilter) &&
+           projectFilter == other.projectFilter &&
+           userFilter == other.userFilter &&
+           dateFilterEnabled == other.dateFilterEnabled &&
+           (!dateFilterEnabled || dateFilter == other.dateFilter) &&
+           showCompleted == other.showCompleted;
+}
+
+bool TaskService::SortOptions::operator==(const SortOptions &other) const
+{
+    return criteria == other.criteria && ascending == other.ascending && keys == other.keys;
+}
+
+QList<SortKey> TaskService::SortOptions::effectiveKeys() const
+{
+    if (!keys.isEmpty()) {
+        return keys;
+    }
+    SortKey field;
+    switch (criteria) {
+    case SortByPriority: field.field = SortKey::ByPriority; break;
+    case SortByTitle: field.field = SortKey::ByTitle; break;
+    case SortByProject: field.field = SortKey::ByProject; break;
+    default: field.field = SortKey::ByDate;
+    }
+    field.ascending = ascending;
+    SortKey completed = { SortKey::ByCompleted, true };
+    return QList<SortKey>() << completed << field;
+}
+
 // Комбинированная фильтрация и сортировка задач
-// Применяет все фильтры последовательно, затем сортирует
+// Повторный запрос с теми же опциями при неизменных данных отдается из кеша за O(1)
 QList<Task*> TaskService::getFilteredAndSortedTasks(const FilterOptions &filterOpts, const SortOptions &sortOpts) const
 {
-    QList<Task*> tasks = getAllTasks();
+    if (!m_taskRepository) {
+        return QList<Task*>();
+    }
+    
+    QueryKey key = { filterOpts, sortOpts };
+    quint64 generation = m_taskRepository->generation();
+    QList<Task*> tasks;
+    if (m_queryCache.lookup(key, generation, tasks)) {
+        return tasks;
+    }
+    
+    tasks = computeFilteredAndSortedTasks(filterOpts, sortOpts);
+    m_queryCache.insert(key, generation, tasks);
+    return tasks;
+}
+
+QList<Task*> TaskService::getTaskPage(const FilterOptions &filterOpts, const SortOptions &sortOpts,
+                                     int offset, int limit) const
+{
+    if (!m_taskRepository || offset < 0 || limit <= 0) {
+        return QList<Task*>();
+    }
     
-    // Поиск по названию
-    if (!filterOpts.searchText.isEmpty()) {
-        QList<Task*> searchResults = searchByTitle(filterOpts.searchText);
-        QList<Task*> filtered;
-        for (Task *task : tasks) {
-            if (searchResults.contains(task)) {
-                filtered.append(task);
-            }
-        }
-        tasks = filtered;
+    // Полный результат уже отсортирован и закеширован - просто берем срез
+    QueryKey key = { filterOpts, sortOpts };
+    quint64 generation = m_taskRepository->generation();
+    QList<Task*> tasks;
+    if (m_queryCache.lookup(key, generation, tasks)) {
+        return tasks.mid(offset, limit);
     }
     
-    // Фильтр по приоритету
-    if (filterOpts.priorityFilterEnabled) {
-        QList<Task*> priorityResults = filterByPriority(filterOpts.priorityFilter);
-        QList<Task*> filtered;
-        for (Task *task : tasks) {
-            if (priorityResults.contains(task)) {
-                filtered.append(task);
-            }
-        }
-        tasks = filtered;
+    bool sorted = false;
+    tasks = matchingTasks(filterOpts, sortOpts, sorted);
+    if (sorted) {
+        rememberSearch(filterOpts, sortOpts, tasks, true);
+        m_queryCache.insert(key, generation, tasks);
+        return tasks.mid(offset, limit);
     }
     
-    // Фильтр по проекту
-    if (filterOpts.projectFilter) {
-        QList<Task*> projectResults = filterByProject(filterOpts.projectFilter);
-        QList<Task*> filtered;
-        for (Task *task : tasks) {
-            if (projectResults.contains(task)) {
-                filtered.append(task);
-            }
-        }
-        tasks = filtered;
+    int windowEnd = offset + limit;
+    TaskSortOrder order(sortOpts);
+    if (windowEnd * 2 >= tasks.size()) {
+        // Окно покрывает большую часть результата - сортируем полностью и кешируем;
+        // уточнение поиска тогда тоже получает отсортированный результат
+        order.sort(tasks);
+        rememberSearch(filterOpts, sortOpts, tasks, true);
+        m_queryCache.insert(key, generation, tasks);
+    } else {
+        // Запоминаем результат до частичной сортировки: в нем все совпадения, но без порядка
+        rememberSearch(filterOpts, sortOpts, tasks, false);
+        order.sortPrefix(tasks, windowEnd);
+    }
+    return tasks.mid(offset, limit);
+}
+
+namespace {
+
+const quint8 CURSOR_VERSION = 2;
+
+void writeSortKeys(QDataStream &out, const QList<SortKey> &keys)
+{
+    out << qint32(keys.size());
+    for (const SortKey &key : keys) {
+        out << qint32(key.field) << key.ascending;
+    }
+}
+
+QList<SortKey> readSortKeys(QDataStream &in)
+{
+    QList<SortKey> keys;
+    qint32 count = 0;
+    in >> count;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        qint32 field = 0;
+        bool ascending = true;
+        in >> field >> ascending;
+        SortKey key = { static_cast<SortKey::Field>(field), ascending };
+        keys.append(key);
+    }
+    return keys;
+}
+
+// Курсор: версия, сортировка и поля ключа последней задачи. Ключ сопоставления
+// названия не сериализуется - он пересчитывается из названия при чтении
+QByteArray encodeCursor(Task *task, const TaskService::SortOptions &sortOpts)
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    TaskSortKey key = TaskSortKey::fromTask(task);
+    out << CURSOR_VERSION;
+    writeSortKeys(out, sortOpts.effectiveKeys());
+    out << key.completed << key.deadline << qint32(key.priority)
+        << task->getTitle() << key.project << qint32(key.id);
+    return data.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+}
+
+bool decodeCursor(const QByteArray &token, const TaskService::SortOptions &sortOpts, TaskSortKey &key)
+{
+    if (token.isEmpty()) {
+        return false;
+    }
+    QByteArray data = QByteArray::fromBase64(token, QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+    QDataStream in(data);
+    quint8 version = 0;
+    in >> version;
+    if (version != CURSOR_VERSION || readSortKeys(in) != sortOpts.effectiveKeys()) {
+        return false;
+    }
+    qint32 priority = 0;
+    qint32 id = 0;
+    QString title;
+    in >> key.completed >> key.deadline >> priority
+       >> title >> key.project >> id;
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+    key.priority = priority;
+    key.title = Task::collationKey(title);
+    key.id = id;
+    return true;
+}
+
+}
+
+TaskService::Cursor TaskService::cursorAfter(Task *task, const SortOptions &sortOpts)
+{
+    Cursor cursor;
+    if (task) {
+        cursor.m_token = encodeCursor(task, sortOpts);
+    }
+    return cursor;
+}
+
+// Продолжение обхода с курсора: без смещения от начала и без сортировки уже выданного
+// Первая страница сортирует только окно. Продолжение сортирует результат один раз
+// и кеширует его, дальше позиция курсора находится бинарным поиском - O(log n)
+// ключей задач на страницу, пока данные не изменились
+TaskService::TaskPage TaskService::getFilteredAndSortedTasks(const FilterOptions &filterOpts, const SortOptions &sortOpts,
+                                                           const Cursor &after, int limit) const
+{
+    TaskPage page;
+    if (!m_taskRepository || limit <= 0) {
+        return page;
     }
     
-    // Фильтр по пользователю
-    if (filterOpts.userFilter) {
-        QList<Task*> userResults = filterByUser(filterOpts.userFilter);
-        QList<Task*> filtered;
-        for (Task *task : tasks) {
-            if (userResults.contains(task)) {
-                filtered.append(task);
-            }
+    TaskSortOrder order(sortOpts);
+    TaskSortKey afterKey;
+    bool hasCursor = decodeCursor(after.m_token, sortOpts, afterKey);
+    
+    QueryKey key = { filterOpts, sortOpts };
+    quint64 generation = m_taskRepository->generation();
+    QList<Task*> tasks;
+    bool sorted = m_queryCache.lookup(key, generation, tasks);
+    if (!sorted) {
+        tasks = matchingTasks(filterOpts, sortOpts, sorted);
+        if (!sorted && hasCursor) {
+            sortTasks(tasks, sortOpts);
+            sorted = true;
+        }
+        rememberSearch(filterOpts, sortOpts, tasks, sorted);
+        if (sorted) {
+            m_queryCache.insert(key, generation, tasks);
         }
-        tasks = filtered;
     }
-    
-    // Фильтр по дате
-    if (filterOpts.dateFilterEnabled && filterOpts.dateFilter.isValid()) {
-        QList<Task*> dateResults = filterByDate(filterOpts.dateFilter);
-        QList<Task*> filtered;
-        for (Task *task : tasks) {
-            if (dateResults.contains(task)) {
-                filtered.append(task);
-            }
+    if (sorted) {
+        int start = 0;
+        if (hasCursor) {
+            QList<Task*>::const_iterator it = std::upper_bound(
+                tasks.constBegin(), tasks.constEnd(), afterKey,
+                [&order](const TaskSortKey &k, Task *task) { return order(k, TaskSortKey::fromTask(task)); });
+            start = int(it - tasks.constBegin());
         }
-        tasks = filtered;
+        page.tasks = tasks.mid(start, limit);
+        if (start + limit < tasks.size()) {
+            page.next = cursorAfter(page.tasks.last(), sortOpts);
+        }
+        return page;
     }
     
-    // Фильтр по статусу завершения
-    if (!filterOpts.showCompleted) {
-        QList<Task*> filtered;
-        for (Task *task : tasks) {
-            if (!task->isCompleted()) {
-                filtered.append(task);
-            }
-        }
-        tasks = filtered;
+    // Одна лишняя задача показывает, есть ли следующая страница
+    order.sortPrefix(tasks, limit + 1);
+    page.tasks = tasks.mid(0, limit);
+    if (tasks.size() > limit) {
+        page.next = cursorAfter(page.tasks.last(), sortOpts);
     }
+    return page;
+}
+
+// Фильтры выполняет QueryPlanner: начинает с самого селективного индекса,
+// остальные условия пересекает через индексы или проверяет на кандидатах
+QList<Task*> TaskService::computeFilteredAndSortedTasks(const FilterOptions &filterOpts, const SortOptions &sortOpts) const
+{
+    bool sorted = false;
+    QList<Task*> tasks = matchingTasks(filterOpts, sortOpts, sorted);
     
     // Сортировка: сначала незавершенные, потом завершенные, затем по выбранному критерию
-    std::sort(tasks.begin(), tasks.end(), [sortOpts](Task *a, Task *b) {
-        bool aCompleted = a->isCompleted();
-        bool bCompleted = b->isCompleted();
-        
-        // Незавершенные всегда перед завершенными
-        if (aCompleted != bCompleted) {
-            return !aCompleted;
-        }
-        
-        bool less;
-        switch (sortOpts.criteria) {
-        case SortOptions::SortByDate:
-            less = a->getDeadline() < b->getDeadline();
-            break;
-        case SortOptions::SortByPriority:
-            less = static_cast<int>(a->getPriority()) < static_cast<int>(b->getPriority());
-            break;
-        case SortOptions::SortByTitle:
-            less = a->getTitle() < b->getTitle();
-            break;
-        case SortOptions::SortByProject:
-            {
-                QString projA = a->getProject() ? a->getProject()->getName() : "";
-                QString projB = b->getProject() ? b->getProject()->getName() : "";
-                less = projA < projB;
-            }
-            break;
-        default:
-            less = false;
-        }
-        return sortOpts.ascending ? less : !less;
-    });
+    // Порядок общий с TaskView, чтобы живое представление совпадало с полным пересчетом
+    if (!sorted) {
+        sortTasks(tasks, sortOpts);
+    }
     
+    rememberSearch(filterOpts, sortOpts, tasks, true);
     return tasks;
 }
 
+// Большие результаты сортируются на нескольких потоках
+void TaskService::sortTasks(QList<Task*> &tasks, const SortOptions &sortOpts) const
+{
+    TaskSortOrder order(sortOpts);
+    if (m_parallelThreshold > 0 && tasks.size() >= m_parallelThreshold) {
+        order.parallelSort(tasks, QThread::idealThreadCount());
+    } else {
+        order.sort(tasks);
+    }
+}
+
+// Задачи, подходящие под фильтры; sorted - уже упорядочены по sortOpts
+// Если запрос уточняет предыдущий (дописаны символы или новые термы), все подходящие
+// задачи уже есть в его результате - перепроверяем их вместо выборки из индексов,
+// когда их не больше, чем кандидатов на пути доступа. Порядок фильтрация сохраняет
+QList<Task*> TaskService::matchingTasks(const FilterOptions &filterOpts, const SortOptions &sortOpts,
+                                       bool &sorted) const
+{
+    QueryPlanner planner(m_taskRepository);
+    planner.setParallelThreshold(m_parallelThreshold);
+    buildPlan(planner, filterOpts);
+    
+    if (narrowsLastSearch(filterOpts) && m_lastSearch.tasks.size() <= planner.accessEstimate()) {
+        QueryMatches queryMatches = { compiledQuery(filterOpts) };
+        QList<Task*> tasks = TaskFilter::apply(m_lastSearch.tasks,
+                                               TaskFilter::all(optionsFilter(filterOpts), queryMatches));
+        sorted = m_lastSearch.sorted && m_lastSearch.sort == sortOpts;
+        return tasks;
+    }
+    
+    sorted = false;
+    return planner.execute();
+}
+
+// Результат предыдущего поиска содержит все задачи, подходящие под filterOpts:
+// данные не менялись, остальные фильтры те же, а текст только дописан
+bool TaskService::narrowsLastSearch(const FilterOptions &filterOpts) const
+{
+    if (!m_lastSearch.valid ||
+        m_lastSearch.generation != m_taskRepository->generation() ||
+        m_lastSearch.catalogGeneration != m_catalogGeneration) {
+        return false;
+    }
+    FilterOptions previous = m_lastSearch.filter;
+    previous.searchText = filterOpts.searchText;
+    previous.query = filterOpts.query;
+    if (!(previous == filterOpts)) {
+        return false;
+    }
+    // Допуск опечаток растет с длиной слова, поэтому дописанный нечеткий
+    // запрос может найти задачи, которых не было в прежнем результате
+    if (filterOpts.fuzzySearch) {
+        return filterOpts.searchText == m_lastSearch.filter.searchText &&
+               filterOpts.query == m_lastSearch.filter.query;
+    }
+    // Название, содержащее строку, содержит и любой ее префикс
+    return filterOpts.searchText.startsWith(m_lastSearch.filter.searchText) &&
+           queryNarrows(m_lastSearch.filter.query, filterOpts.query);
+}
+
+// Каждая задача, подходящая под current, подходит и под previous. Стирание символов
+// и правка в середине строки сюда не попадают - для них выполняется полный поиск
+bool TaskService::queryNarrows(const QString &previous, const QString &current) const
+{
+    if (previous.trimmed().isEmpty() || previous == current) {
+        return true;
+    }
+    if (!current.startsWith(previous)) {
+        return false;
+    }
+    QSharedPointer<const CompiledQuery> before = compiledQuery(previous);
+    QSharedPointer<const CompiledQuery> after = compiledQuery(current);
+    if (before->plainText && after->plainText) {
+        return true;
+    }
+    // Дописаны новые термы: прежние закончены (граница - пробел, кавычки закрыты)
+    // и остаются в конъюнкции. Обычный текст из нескольких слов при этом разбился
+    // бы на отдельные слова, поэтому так уточняется только однословный
+    bool boundary = current.at(previous.size()).isSpace() && previous.count(QLatin1Char('"')) % 2 == 0;
+    return boundary && (!before->plainText || !previous.trimmed().contains(QLatin1Char(' ')));
+}
+
+void TaskService::rememberSearch(const FilterOptions &filterOpts, const SortOptions &sortOpts,
+                                 const QList<Task*> &tasks, bool sorted) const
+{
+    m_lastSearch.filter = filterOpts;
+    m_lastSearch.sort = sortOpts;
+    m_lastSearch.tasks = tasks;
+    m_lastSearch.sorted = sorted;
+    m_lastSearch.generation = m_taskRepository->generation();
+    m_lastSearch.catalogGeneration = m_catalogGeneration;
+    m_lastSearch.valid = true;
+}
+
+// Условия FilterOptions и текстового запроса планируются вместе
+void TaskService::buildPlan(QueryPlanner &planner, const FilterOptions &filterOpts) const
+{
+    QSharedPointer<const CompiledQuery> query = compiledQuery(filterOpts);
+    planner.build(filterOpts, query ? query->predicates : QList<QueryPredicatePtr>());
+}
+
+// Компиляция текстового запроса с кешем по тексту: повторный и
+// возвращенный к прежнему вид строки поиска не разбираются заново
+// В нечетком режиме сюда же добавляется предикат для fuzzyText: образцы слов
+// строятся один раз, а не на каждую проверяемую задачу
+QSharedPointer<const CompiledQuery> TaskService::compiledQuery(const QString &query, bool fuzzy,
+                                                               const QString &fuzzyText) const
+{
+    if (query.trimmed().isEmpty() && fuzzyText.isEmpty()) {
+        return QSharedPointer<const CompiledQuery>();
+    }
+    CompiledQueryKey key = { query, fuzzyText, fuzzy, QDate::currentDate() };
+    QSharedPointer<const CompiledQuery> compiled;
+    if (m_compiledQueries.lookup(key, m_catalogGeneration, compiled)) {
+        return compiled;
+    }
+    QueryCompiler compiler(m_userRepository, m_projectRepository, fuzzy);
+    CompiledQuery *result = new CompiledQuery(compiler.compile(query, key.today));
+    if (!fuzzyText.isEmpty()) {
+        result->predicates.prepend(QueryPredicate::fuzzyTitle(fuzzyText));
+    }
+    compiled = QSharedPointer<const CompiledQuery>(result);
+    m_compiledQueries.insert(key, m_catalogGeneration, compiled);
+    return compiled;
+}
+
+QSharedPointer<const CompiledQuery> TaskService::compiledQuery(const FilterOptions &filterOpts) const
+{
+    return compiledQuery(filterOpts.query, filterOpts.fuzzySearch,
+                         filterOpts.fuzzySearch ? filterOpts.searchText : QString());
+}
+
+QString TaskService::queryError(const QString &query) const
+{
+    QSharedPointer<const CompiledQuery> compiled = compiledQuery(query);
+    return compiled ? compiled->error : QString();
+}
+
+// Проверка одной задачи на соответствие фильтрам - те же условия, что у QueryPlanner
+bool TaskService::matchesFilter(Task *task, const FilterOptions &filterOpts) const
+{
+    if (!matchesOptions(task, filterOpts)) {
+        return false;
+    }
+    QSharedPointer<const CompiledQuery> query = compiledQuery(filterOpts);
+    return !query || query->matches(task);
+}
+
+TaskService::OptionsFilter TaskService::optionsFilter(const FilterOptions &filterOpts)
+{
+    TaskFilter::TitleContains title = { filterOpts.searchText };
+    TaskFilter::PriorityIs priority = { filterOpts.priorityFilter };
+    TaskFilter::ProjectIs project = { filterOpts.projectFilter };
+    TaskFilter::OwnerIs owner = { filterOpts.userFilter };
+    TaskFilter::DueOn due = { filterOpts.dateFilter.date() };
+    TaskFilter::CompletedIs active = { false };
+    return OptionsFilter(TaskFilter::when(!filterOpts.searchText.isEmpty() && !filterOpts.fuzzySearch, title),
+                         TaskFilter::when(filterOpts.priorityFilterEnabled, priority),
+                         TaskFilter::when(filterOpts.projectFilter != nullptr, project),
+                         TaskFilter::when(filterOpts.userFilter != nullptr, owner),
+                         TaskFilter::when(filterOpts.dateFilterEnabled && filterOpts.dateFilter.isValid(), due),
+                         TaskFilter::when(!filterOpts.showCompleted, active));
+}
+
+bool TaskService::matchesOptions(Task *task, const FilterOptions &filterOpts)
+{
+    return task && optionsFilter(filterOpts)(task);
+}
+
+// План выполнения фильтров в текстовом виде (для отладки)
+QString TaskService::explainQuery(const FilterOptions &filterOpts) const
+{
+    QueryPlanner planner(m_taskRepository);
+    buildPlan(planner, filterOpts);
+    return planner.explain();
+}
+
+TaskService::QueryCacheStats TaskService::getQueryCacheStats() const
+{
+    GenerationCache<QueryKey, QList<Task*>>::Stats stats = m_queryCache.stats();
+    QueryCacheStats result = { stats.hits, stats.misses };
+    return result;
+}
+
 // Получение статистики по задачам
 TaskService::TaskStatistics TaskService::getStatistics() const
 {
@@ -3,9 +3,19 @@
 
 #include "repositories.h"
 #include "strategies.h"
+#include "filtercombinators.h"
+#include "generationcache.h"
+#include "taskstream.h"
 #include <QObject>
 #include <QList>
 #include <QJsonObject>
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QPair>
+#include <QDate>
+
+class QueryPlanner;
+struct CompiledQuery;
 
 // Фасад (Facade Pattern) для работы с данными
 // Объединяет работу с репозиториями задач, пользователей и проектов
@@ -23,27 +33,69 @@ public:
     void addTask(Task *task);
     void removeTask(Task *task);
     QList<Task*> getAllTasks() const;
+    Task* findTaskById(int id) const;
+    // Ленивый обход задач в порядке добавления: ничего не копируется, пока поток
+    // не начнут читать (filter / map / take / groupBy, см. TaskStream)
+    TaskStream<Task*> stream() const;
     
     void addUser(User *user);
     void removeUser(User *user);
     QList<User*> getAllUsers() const;
     User* findUserById(int id) const;
     User* findUserByName(const QString &name) const;
+    void renameUser(User *user, const QString &name);
     
     void addProject(Project *project);
     void removeProject(Project *project);
     QList<Project*> getAllProjects() const;
     Project* findProjectById(int id) const;
     Project* findProjectByName(const QString &name) const;
+    void renameProject(Project *project, const QString &name);
     
-    // Фильтрация задач через Strategy Pattern
+    // Фильтрация задач через Strategy Pattern: стратегии применяются по очереди,
+    // каждая через свой filter() к результату предыдущей
     QList<Task*> filterTasks(const QList<IFilterStrategy*> &filters) const;
+    // Составной предикат TaskFilter (And / Or / Not) - один проход по задачам
+    // без виртуальных вызовов и промежуточных списков
+    template<typename Predicate>
+    QList<Task*> filterTasks(const Predicate &predicate) const
+    {
+        return TaskFilter::apply(getAllTasks(), predicate);
+    }
     QList<Task*> filterByPriority(Priority priority) const;
     QList<Task*> filterByDate(const QDateTime &date) const;
     QList<Task*> filterByProject(Project *project) const;
     QList<Task*> filterByUser(User *user) const;
     QList<Task*> filterCompleted(bool completed) const;
-    QList<Task*> searchByTitle(const QString &keyword) const;
+    // fuzzy - слова названия с опечатками (1-2 правки, последнее слово - как префикс)
+    QList<Task*> searchByTitle(const QString &keyword, bool fuzzy = false) const;
+    // Ранжированный поиск по названиям и описаниям (BM25): лучшие limit задач,
+    // слова в кавычках ищутся как фраза. Индекс обновляется при изменении задачи
+    QList<Task*> searchFullText(const QString &query, int limit = 50) const;
+    
+    // Подсказки для полей ввода: до limit вариантов, начинающихся с prefix
+    // (без учета регистра), самые частые первыми. Индексы обновляются при
+    // добавлении, удалении и переименовании через репозитории
+    QStringList completeTitle(const QString &prefix, int limit = 10) const;
+    QStringList completeUserName(const QString &prefix, int limit = 10) const;
+    QStringList completeProjectName(const QString &prefix, int limit = 10) const;
+    
+    // Почти одинаковые задачи ("Подготовить отчет" и "Подготовить отчёт за месяц"):
+    // подписи названий обновляются при каждом изменении, поэтому отчет не сравнивает
+    // все пары задач. threshold - оценка доли общих троек символов названий
+    QList<QList<Task*>> findNearDuplicateClusters(double threshold = 0.5) const;
+    QList<Task*> findNearDuplicates(const QString &title, double threshold = 0.5) const;
+    
+    // Запросы по упорядоченному индексу дедлайнов, результат отсортирован по дедлайну
+    // Задачи с дедлайном в полуинтервале [from, to)
+    QList<Task*> getTasksDueBetween(const QDateTime &from, const QDateTime &to,
+                                    bool activeOnly = false) const;
+    // Ближайшие count незавершенных задач с дедлайном не раньше from (по умолчанию - сейчас)
+    QList<Task*> getNextDueTasks(int count, const QDateTime &from = QDateTime()) const;
+    // Незавершенные задачи с прошедшим дедлайном
+    QList<Task*> getOverdueTasks(const QDateTime &now = QDateTime()) const;
+    // Наибольшее упреждение напоминания среди незавершенных задач с дедлайном (минуты)
+    int getMaxReminderMinutes() const;
     
     QJsonObject toJson() const;
     void fromJson(const QJsonObject &obj);
@@ -62,6 +114,11 @@ public:
     // Комбинированная фильтрация и сортировка задач
     struct FilterOptions {
         QString searchText;
+        // Текстовый запрос, например owner:"Иван Иванов" priority>=medium !is:done (см. QueryCompiler)
+        // Без полей и операторов работает как searchText
+        QString query;
+        // searchText и слова query ищутся с опечатками (см. FuzzyTitleIndex)
+        bool fuzzySearch = false;
         Priority priorityFilter = Priority::Low; // -1 означает "все"
         bool priorityFilterEnabled = false;
         Project *projectFilter = nullptr;
@@ -69,15 +126,77 @@ public:
         QDateTime dateFilter;
         bool dateFilterEnabled = false;
         bool showCompleted = true;
+        
+        bool operator==(const FilterOptions &other) const;
     };
     
     struct SortOptions {
         enum Criteria { SortByDate, SortByPriority, SortByTitle, SortByProject };
         Criteria criteria = SortByDate;
         bool ascending = true;
+        // Составной ключ, например {ByPriority, desc}, {ByDate, asc}, {ByTitle, asc}
+        // Если задан, используется вместо criteria/ascending как есть
+        QList<SortKey> keys;
+        
+        // Ключи сортировки: keys либо "незавершенные первыми" + criteria
+        QList<SortKey> effectiveKeys() const;
+        bool operator==(const SortOptions &other) const;
     };
     
+    // Начиная с этого размера фильтрация и сортировка выполняются в пуле потоков
+    // (0 - всегда последовательно). Результат совпадает с последовательным
+    void setParallelThreshold(int threshold) { m_parallelThreshold = threshold; }
+    int parallelThreshold() const { return m_parallelThreshold; }
+    
+    // Ленивый обход задач, подходящих под фильтры (без сортировки и кеша)
+    TaskStream<Task*> stream(const FilterOptions &filterOpts) const;
+    
+    // Результат кешируется по (FilterOptions, SortOptions) до следующего изменения данных
     QList<Task*> getFilteredAndSortedTasks(const FilterOptions &filterOpts, const SortOptions &sortOpts) const;
+    // Страница результата [offset, offset + limit) в том же порядке, что и
+    // getFilteredAndSortedTasks. Сортируется только окно (top-K), поэтому первая
+    // страница большого результата строится без полной сортировки
+    QList<Task*> getTaskPage(const FilterOptions &filterOpts, const SortOptions &sortOpts,
+                             int offset, int limit) const;
+    // Непрозрачный курсор постраничного обхода (keyset pagination)
+    // Хранит ключ сортировки и ID последней выданной задачи - значения, а не позицию,
+    // поэтому остается корректным при добавлении и удалении задач между запросами
+    class Cursor {
+    public:
+        bool isNull() const { return m_token.isEmpty(); }
+        // Текстовое представление для передачи между процессами
+        QByteArray toToken() const { return m_token; }
+        static Cursor fromToken(const QByteArray &token) { Cursor cursor; cursor.m_token = token; return cursor; }
+    private:
+        friend class TaskService;
+        QByteArray m_token;
+    };
+    
+    struct TaskPage {
+        QList<Task*> tasks;
+        Cursor next; // пустой, если страница последняя
+    };
+    
+    // Следующие limit задач после курсора (пустой курсор - с начала результата).
+    // Курсор, выданный для другой сортировки, считается пустым
+    TaskPage getFilteredAndSortedTasks(const FilterOptions &filterOpts, const SortOptions &sortOpts,
+                                       const Cursor &after, int limit) const;
+    // Курсор, указывающий сразу за задачей в заданной сортировке
+    static Cursor cursorAfter(Task *task, const SortOptions &sortOpts);
+    
+    // Проверка одной задачи на соответствие фильтрам (для инкрементального обновления списков)
+    bool matchesFilter(Task *task, const FilterOptions &filterOpts) const;
+    // Ошибка разбора текстового запроса (пустая строка - запрос корректен)
+    QString queryError(const QString &query) const;
+    // Описание плана, который планировщик выберет для фильтров (для отладки)
+    QString explainQuery(const FilterOptions &filterOpts) const;
+    
+    // Счетчики попаданий и промахов кеша запросов
+    struct QueryCacheStats {
+        int hits;
+        int misses;
+    };
+    QueryCacheStats getQueryCacheStats() const;
     
     // Статистика задач
     struct TaskStatistics {
@@ -99,11 +218,84 @@ signals:
     void taskAdded(Task *task);
     void taskRemoved(Task *task);
     void taskUpdated(Task *task);
+    // Изменены поля задачи (маска Task::Fields); приходит после taskUpdated
+    void taskFieldsChanged(int taskId, Task::Fields fields);
+    // Переименованы пользователь или проект либо все данные очищены -
+    // построчно поддерживаемые представления нужно перестроить
+    void catalogChanged();
 
 private:
+    class JsonTaskImporter;
+    
+    struct QueryKey {
+        FilterOptions filter;
+        SortOptions sort;
+        bool operator==(const QueryKey &other) const { return filter == other.filter && sort == other.sort; }
+    };
+    
+    // Последний выполненный поиск - основа для уточнения при наборе текста
+    // Ключ кеша скомпилированных запросов; fuzzyText - searchText в нечетком режиме
+    struct CompiledQueryKey {
+        QString query;
+        QString fuzzyText;
+        bool fuzzy;
+        QDate today;
+        bool operator==(const CompiledQueryKey &other) const
+        {
+            return query == other.query && fuzzyText == other.fuzzyText &&
+                   fuzzy == other.fuzzy && today == other.today;
+        }
+    };
+    
+    struct SearchState {
+        FilterOptions filter;
+        SortOptions sort;
+        QList<Task*> tasks;
+        bool sorted = false;
+        bool valid = false;
+        quint64 generation = 0;
+        quint64 catalogGeneration = 0;
+    };
+    
+    QList<Task*> computeFilteredAndSortedTasks(const FilterOptions &filterOpts, const SortOptions &sortOpts) const;
+    QList<Task*> matchingTasks(const FilterOptions &filterOpts, const SortOptions &sortOpts, bool &sorted) const;
+    void sortTasks(QList<Task*> &tasks, const SortOptions &sortOpts) const;
+    bool narrowsLastSearch(const FilterOptions &filterOpts) const;
+    bool queryNarrows(const QString &previous, const QString &current) const;
+    void rememberSearch(const FilterOptions &filterOpts, const SortOptions &sortOpts,
+                        const QList<Task*> &tasks, bool sorted) const;
+    void catalogModified();
+    void buildPlan(QueryPlanner &planner, const FilterOptions &filterOpts) const;
+    QSharedPointer<const CompiledQuery> compiledQuery(const QString &query, bool fuzzy = false,
+                                                      const QString &fuzzyText = QString()) const;
+    QSharedPointer<const CompiledQuery> compiledQuery(const FilterOptions &filterOpts) const;
+    // Условия FilterOptions без текстового запроса одним составным предикатом
+    // (нечеткий searchText проверяет скомпилированный запрос)
+    typedef TaskFilter::And<TaskFilter::When<TaskFilter::TitleContains>,
+                            TaskFilter::When<TaskFilter::PriorityIs>,
+                            TaskFilter::When<TaskFilter::ProjectIs>,
+                            TaskFilter::When<TaskFilter::OwnerIs>,
+                            TaskFilter::When<TaskFilter::DueOn>,
+                            TaskFilter::When<TaskFilter::CompletedIs>> OptionsFilter;
+    static OptionsFilter optionsFilter(const FilterOptions &filterOpts);
+    static bool matchesOptions(Task *task, const FilterOptions &filterOpts);
+    
     ITaskRepository *m_taskRepository;
     IUserRepository *m_userRepository;
     IProjectRepository *m_projectRepository;
+    // Кеш результатов, проверяется по поколению репозитория задач
+    mutable GenerationCache<QueryKey, QList<Task*>> m_queryCache;
+    // Скомпилированные текстовые запросы по (текст, режим, сегодняшняя дата). Запрос хранит
+    // найденных пользователей и проекты, поэтому поколение - поколение справочников
+    mutable GenerationCache<CompiledQueryKey, QSharedPointer<const CompiledQuery>> m_compiledQueries;
+    quint64 m_catalogGeneration;
+    mutable SearchState m_lastSearch;
+    int m_parallelThreshold;
+    
+    // На меньших объемах запуск задач в пуле дороже выигрыша
+    static const int DEFAULT_PARALLEL_THRESHOLD = 100000;
+    // Строка поиска компилируется на каждое нажатие - держим недавние префиксы
+    static const int COMPILED_QUERY_CACHE_SIZE = 64;
 };
 
 #endif // TASKSERVICE_H
@@ -0,0 +1,473 @@
+#include "tasksortkey.h"
+#include "../models/task.h"
+#include "../models/project.h"
+#include <QPair>
+#include <QFuture>
+#include <QtConcurrent/QtConcurrentRun>
+#include <limits>
+#include <algorithm>
+
+// Ключ пустого названия вычисляется один раз: инициализация локальной статической
+// переменной потокобезопасна, а общий коллатор - нет (ключи строятся и в пуле потоков)
+static QCollatorSortKey emptyTitleKey()
+{
+    static const QCollatorSortKey key = Task::collationKey(QString());
+    return key;
+}
+
+TaskSortKey::TaskSortKey()
+    : completed(false),
+      deadline(std::numeric_limits<qint64>::min()),
+      priority(0),
+      title(emptyTitleKey()),
+      id(-1)
+{
+}
+
+TaskSortKey TaskSortKey::fromTask(Task *task)
+{
+    TaskSortKey key;
+    key.completed = task->isCompleted();
+    key.deadline = task->getDeadline().isValid() ? task->getDeadline().toMSecsSinceEpoch()
+                                                 : std::numeric_limits<qint64>::min();
+    key.priority = static_cast<int>(task->getPriority());
+    key.title = task->getTitleSortKey();
+    key.project = task->getProject() ? task->getProject()->getName() : QString();
+    key.id = task->getId();
+    return key;
+}
+
+TaskSortOrder::TaskSortOrder(const TaskService::SortOptions &sortOpts)
+    : m_keys(sortOpts.effectiveKeys())
+{
+}
+
+TaskSortOrder::TaskSortOrder(const QList<SortKey> &keys)
+    : m_keys(keys)
+{
+}
+
+bool TaskSortOrder::operator()(const TaskSortKey &a, const TaskSortKey &b) const
+{
+    for (const SortKey &key : m_keys) {
+        int cmp = compareField(key.field, a, b);
+        if (cmp != 0) {
+            return key.ascending ? cmp < 0 : cmp > 0;
+        }
+    }
+    return a.id < b.id;
+}
+
+bool TaskSortOrder::operator()(Task *a, Task *b) const
+{
+    return (*this)(TaskSortKey::fromTask(a), TaskSortKey::fromTask(b));
+}
+
+void TaskSortOrder::sort(QList<Task*> &tasks) const
+{
+    if (tasks.size() < 2) {
+        return;
+    }
+    sortFlat(tasks, tasks.size());
+}
+
+// Параллельная сортировка. Плоские ключи строятся один раз для всего списка:
+// ранги названий и проектов общие, поэтому номера из разных кусков сравнимы.
+// Куски массива номеров сортируются в пуле потоков и сливаются попарно,
+// задачи переставляются один раз в конце. Порядок строгий и полный,
+// поэтому результат совпадает с sort()
+void TaskSortOrder::parallelSort(QList<Task*> &tasks, int chunkCount) const
+{
+    if (chunkCount < 2 || tasks.size() < chunkCount * 2) {
+        sort(tasks);
+        return;
+    }
+
+    const int n = tasks.size();
+    const FlatKeys flat = flatten(tasks);
+    QVector<int> ids(n);
+    QVector<int> order(n);
+    for (int i = 0; i < n; ++i) {
+        ids[i] = tasks.at(i)->getId();
+        order[i] = i;
+    }
+    const FlatLess less(flat, ids);
+
+    // Границы отсортированных отрезков: отрезок i - [bounds[i], bounds[i + 1])
+    const int chunkSize = (n + chunkCount - 1) / chunkCount;
+    QVector<int> bounds;
+    for (int start = 0; start < n; start += chunkSize) {
+        bounds.append(start);
+    }
+    bounds.append(n);
+
+    int *indexes = order.data();
+    QList<QFuture<void>> futures;
+    for (int i = 0; i + 1 < bounds.size(); ++i) {
+        const int from = bounds.at(i);
+        const int to = bounds.at(i + 1);
+        futures.append(QtConcurrent::run([indexes, from, to, less]() {
+            std::sort(indexes + from, indexes + to, less);
+        }));
+    }
+    for (QFuture<void> &future : futures) {
+        future.waitForFinished();
+    }
+
+    // Соседние отрезки сливаются из order в buffer, затем массивы меняются местами
+    QVector<int> buffer(n);
+    while (bounds.size() > 2) {
+        const int *source = order.constData();
+        int *target = buffer.data();
+        QVector<int> next;
+        QList<QFuture<void>> merges;
+        for (int i = 0; i + 1 < bounds.size(); i += 2) {
+            const int from = bounds.at(i);
+            next.append(from);
+            if (i + 2 < bounds.size()) {
+                const int middle = bounds.at(i + 1);
+                const int to = bounds.at(i + 2);
+                merges.append(QtConcurrent::run([source, target, from, middle, to, less]() {
+                    std::merge(source + from, source + middle, source + middle, source + to,
+                               target + from, less);
+                }));
+            } else {
+                std::copy(source + from, source + bounds.at(i + 1), target + from);
+            }
+        }
+        next.append(n);
+        for (QFuture<void> &future : merges) {
+            future.waitForFinished();
+        }
+        bounds = next;
+        order.swap(buffer);
+    }
+
+    QList<Task*> sorted;
+    sorted.reserve(n);
+    for (int index : order) {
+        sorted.append(tasks.at(index));
+    }
+    tasks = sorted;
+}
+
+// Частичная сортировка: упорядочиваются только первые count задач (top-K),
+// остальные остаются после них в произвольном порядке. Стоимость O(n log count)
+void TaskSortOrder::sortPrefix(QList<Task*> &tasks, int count) const
+{
+    count = qMin(count, tasks.size());
+    if (count <= 0) {
+        return;
+    }
+    // Окно больше половины списка - полная сортировка выгоднее
+    if (count * 2 >= tasks.size()) {
+        sort(tasks);
+        return;
+    }
+    sortFlat(tasks, count);
+}
+
+namespace {
+
+// Число бит для значений 0..maxValue
+int bitsFor(quint64 maxValue)
+{
+    int bits = 1;
+    while (bits < 64 && (maxValue >> bits) != 0) {
+        ++bits;
+    }
+    return bits;
+}
+
+}
+
+// Упаковка ключей: каждое поле превращается в целое нужной ширины (проекты и названия -
+// в ранги), убывающие поля инвертируются, поля кладутся от старших бит к младшим;
+// поле, не влезающее в остаток слова, начинает новое слово
+TaskSortOrder::FlatKeys TaskSortOrder::flatten(const QList<Task*> &tasks) const
+{
+    struct Field {
+        SortKey key;
+        int bits;
+        int word;
+        int shift;
+    };
+
+    QHash<Project*, quint32> projectOrdinals;
+    QVector<quint32> titleRanks;
+    // Дедлайны хранятся смещением от минимального - обычно это ~40 бит,
+    // и вместе с признаком завершения ключ помещается в одно слово
+    quint64 deadlineBase = 0;
+    quint64 deadlineRange = 0;
+    bool deadlinesScanned = false;
+    QVector<Field> fields;
+    int words = 0;
+    int freeBits = 0;
+    for (const SortKey &key : m_keys) {
+        int bits;
+        switch (key.field) {
+        case SortKey::ByCompleted:
+            bits = 1;
+            break;
+        case SortKey::ByPriority:
+            bits = 2;
+            break;
+        case SortKey::ByProject:
+            if (projectOrdinals.isEmpty()) {
+                projectOrdinals = TaskKeySorter::projectOrdinals(tasks);
+            }
+            bits = bitsFor(projectOrdinals.size());
+            break;
+        case SortKey::ByTitle:
+            if (titleRanks.isEmpty()) {
+                titleRanks = TaskKeySorter::titleRanks(tasks);
+            }
+            bits = bitsFor(quint64(tasks.size()));
+            break;
+        default:
+            if (!deadlinesScanned) {
+                deadlinesScanned = true;
+                quint64 maxKey = 0;
+                deadlineBase = ~quint64(0);
+                for (Task *task : tasks) {
+                    quint64 k = TaskKeySorter::deadlineKey(task);
+                    deadlineBase = qMin(deadlineBase, k);
+                    maxKey = qMax(maxKey, k);
+                }
+                deadlineRange = tasks.isEmpty() ? 0 : maxKey - deadlineBase;
+            }
+            bits = bitsFor(deadlineRange);
+        }
+        if (bits > freeBits) {
+            ++words;
+            freeBits = 64;
+        }
+        freeBits -= bits;
+        Field field = { key, bits, words - 1, freeBits };
+        fields.append(field);
+    }
+
+    FlatKeys flat;
+    flat.words = words;
+    flat.data.fill(0, tasks.size() * words);
+    for (int i = 0; i < tasks.size(); ++i) {
+        Task *task = tasks.at(i);
+        quint64 *row = flat.data.data() + i * words;
+        for (const Field &field : fields) {
+            quint64 value;
+            switch (field.key.field) {
+            case SortKey::ByCompleted:
+                value = task->isCompleted() ? 1 : 0;
+                break;
+            case SortKey::ByPriority:
+                value = quint64(static_cast<int>(task->getPriority()));
+                break;
+            case SortKey::ByProject:
+                value = projectOrdinals.value(task->getProject());
+                break;
+            case SortKey::ByTitle:
+                value = titleRanks.at(i);
+                break;
+            default:
+                value = TaskKeySorter::deadlineKey(task) - deadlineBase;
+            }
+            quint64 mask = field.bits == 64 ? ~quint64(0) : (quint64(1) << field.bits) - 1;
+            if (!field.key.ascending) {
+                value = mask - value;
+            }
+            row[field.word] |= value << field.shift;
+        }
+    }
+    return flat;
+}
+
+// Сортирует (полностью или первые count) по плоским ключам, при равенстве - по ID
+void TaskSortOrder::sortFlat(QList<Task*> &tasks, int count) const
+{
+    FlatKeys flat = flatten(tasks);
+
+    if (flat.words <= 1) {
+        // Ключ в одном слове: пары (ключ, ID) сортируются поразрядно
+        QVector<TaskKeySorter::Entry> entries;
+        entries.reserve(tasks.size());
+        for (int i = 0; i < tasks.size(); ++i) {
+            // ID при равенстве всегда по возрастанию (знаковое -> беззнаковое с сохранением порядка)
+            TaskKeySorter::Entry entry = { flat.words ? flat.data.at(i) : 0,
+                                           quint32(tasks.at(i)->getId()) ^ 0x80000000u, tasks.at(i) };
+            entries.append(entry);
+        }
+        if (count < entries.size()) {
+            std::partial_sort(entries.begin(), entries.begin() + count, entries.end(),
+                              [](const TaskKeySorter::Entry &a, const TaskKeySorter::Entry &b) {
+                return a.key != b.key ? a.key < b.key : a.tie < b.tie;
+            });
+        } else {
+            TaskKeySorter::radixSort(entries);
+        }
+        for (int i = 0; i < entries.size(); ++i) {
+            tasks[i] = entries.at(i).task;
+        }
+        return;
+    }
+
+    // Несколько слов: один проход сравнения слов подряд без обращения к задачам
+    QVector<int> ids(tasks.size());
+    QVector<int> order(tasks.size());
+    for (int i = 0; i < tasks.size(); ++i) {
+        ids[i] = tasks.at(i)->getId();
+        order[i] = i;
+    }
+    const FlatLess less(flat, ids);
+    if (count < order.size()) {
+        std::partial_sort(order.begin(), order.begin() + count, order.end(), less);
+    } else {
+        std::sort(order.begin(), order.end(), less);
+    }
+    QList<Task*> sorted;
+    sorted.reserve(tasks.size());
+    for (int index : order) {
+        sorted.append(tasks.at(index));
+    }
+    tasks = sorted;
+}
+
+int TaskSortOrder::compareField(SortKey::Field field, const TaskSortKey &a, const TaskSortKey &b)
+{
+    switch (field) {
+    case SortKey::ByCompleted:
+        return int(a.completed) - int(b.completed);
+    case SortKey::ByDate:
+        return a.deadline < b.deadline ? -1 : (b.deadline < a.deadline ? 1 : 0);
+    case SortKey::ByPriority:
+        return a.priority - b.priority;
+    case SortKey::ByTitle:
+        return a.title.compare(b.title);
+    case SortKey::ByProject:
+        return QString::compare(a.project, b.project);
+    default:
+        return 0;
+    }
+}
+
+quint64 TaskKeySorter::deadlineKey(Task *task)
+{
+    if (!task->getDeadline().isValid()) {
+        return 0;
+    }
+    // Смена знакового бита сохраняет порядок при переходе к беззнаковому числу
+    return quint64(task->getDeadline().toMSecsSinceEpoch()) ^ (quint64(1) << 63);
+}
+
+QHash<Project*, quint32> TaskKeySorter::projectOrdinals(const QList<Task*> &tasks)
+{
+    // Проектов немного - их названия сортируются один раз, а не при каждом сравнении задач
+    QList<Project*> projects;
+    QHash<Project*, quint32> ordinals;
+    for (Task *task : tasks) {
+        Project *project = task->getProject();
+        if (!ordinals.contains(project)) {
+            ordinals.insert(project, 0);
+            projects.append(project);
+        }
+    }
+
+    QVector<QPair<QString, Project*>> names;
+    names.reserve(projects.size());
+    for (Project *project : projects) {
+        names.append(qMakePair(project ? project->getName() : QString(), project));
+    }
+    std::sort(names.begin(), names.end(), [](const QPair<QString, Project*> &a, const QPair<QString, Project*> &b) {
+        return QString::compare(a.first, b.first) < 0;
+    });
+
+    quint32 ordinal = 0;
+    for (int i = 0; i < names.size(); ++i) {
+        if (i > 0 && QString::compare(names.at(i - 1).first, names.at(i).first) != 0) {
+            ++ordinal;
+        }
+        ordinals[names.at(i).second] = ordinal;
+    }
+    return ordinals;
+}
+
+QVector<quint32> TaskKeySorter::titleRanks(const QList<Task*> &tasks)
+{
+    QVector<QCollatorSortKey> keys;
+    keys.reserve(tasks.size());
+    QVector<int> order(tasks.size());
+    for (int i = 0; i < tasks.size(); ++i) {
+        keys.append(tasks.at(i)->getTitleSortKey());
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&keys](int a, int b) {
+        return keys.at(a).compare(keys.at(b)) < 0;
+    });
+
+    QVector<quint32> ranks(tasks.size());
+    quint32 rank = 0;
+    for (int i = 0; i < order.size(); ++i) {
+        if (i > 0 && keys.at(order.at(i - 1)).compare(keys.at(order.at(i))) != 0) {
+            ++rank;
+        }
+        ranks[order.at(i)] = rank;
+    }
+    return ranks;
+}
+
+namespace {
+
+// Разряды 0-3 - байты tie (младшие), 4-11 - байты key
+const int DIGITS = 12;
+
+inline uint digitOf(const TaskKeySorter::Entry &entry, int digit)
+{
+    if (digit < 4) {
+        return (entry.tie >> (8 * digit)) & 0xFF;
+    }
+    return uint(entry.key >> (8 * (digit - 4))) & 0xFF;
+}
+
+}
+
+void TaskKeySorter::radixSort(QVector<Entry> &entries)
+{
+    const int n = entries.size();
+    if (n < RADIX_THRESHOLD) {
+        std::stable_sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+            return a.key != b.key ? a.key < b.key : a.tie < b.tie;
+        });
+        return;
+    }
+
+    // Гистограммы всех разрядов за один проход
+    QVector<int> counts(DIGITS * 256, 0);
+    for (const Entry &entry : entries) {
+        for (int digit = 0; digit < DIGITS; ++digit) {
+            ++counts[digit * 256 + digitOf(entry, digit)];
+        }
+    }
+
+    QVector<Entry> buffer(n);
+    Entry *src = entries.data();
+    Entry *dst = buffer.data();
+    for (int digit = 0; digit < DIGITS; ++digit) {
+        int *count = counts.data() + digit * 256;
+        // Все элементы с одинаковым разрядом - проход ничего не меняет
+        if (count[digitOf(src[0], digit)] == n) {
+            continue;
+        }
+        int offsets[256];
+        int sum = 0;
+        for (int b = 0; b < 256; ++b) {
+            offsets[b] = sum;
+            sum += count[b];
+        }
+        for (int i = 0; i < n; ++i) {
+            dst[offsets[digitOf(src[i], digit)]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+    if (src != entries.data()) {
+        std::copy(src, src + n, entries.data());
+    }
+}
@@ -0,0 +1,138 @@
+#ifndef TASKSORTKEY_H
+#define TASKSORTKEY_H
+
+#include "taskservice.h"
+#include <QString>
+#include <QCollatorSortKey>
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+class Task;
+class Project;
+
+// Значения полей задачи, участвующих в сортировке
+// Снимок позволяет найти прежнюю позицию задачи в отсортированном списке
+// после того, как ее поля уже изменились
+struct TaskSortKey {
+    TaskSortKey();
+
+    bool completed;
+    qint64 deadline; // мс с начала эпохи, невалидный дедлайн - минимальное значение
+    int priority;
+    QCollatorSortKey title; // копия ключа задачи, переживает смену названия
+    QString project;
+    int id;
+
+    static TaskSortKey fromTask(Task *task);
+};
+
+// Сортировка задач по заранее извлеченным целочисленным ключам
+// Вместо преобразований в компараторе (копии строк, сравнение QDateTime) каждая задача
+// один раз превращается в пару (ключ, задача), пары сортируются поразрядно
+class TaskKeySorter
+{
+public:
+    struct Entry {
+        quint64 key;
+        quint32 tie; // второй ключ при равенстве key
+        Task *task;
+    };
+
+    // Дедлайн как беззнаковое число с тем же порядком; невалидный дедлайн - 0
+    static quint64 deadlineKey(Task *task);
+    // Порядковые номера проектов задач по названию (одинаковые названия - один номер)
+    static QHash<Project*, quint32> projectOrdinals(const QList<Task*> &tasks);
+    // Ранги названий задач по ключам сопоставления (одинаковые названия - один ранг)
+    static QVector<quint32> titleRanks(const QList<Task*> &tasks);
+
+    // Устойчивая LSD-сортировка по (key, tie) байтовыми разрядами;
+    // разряды, одинаковые у всех элементов, пропускаются
+    static void radixSort(QVector<Entry> &entries);
+
+    // Сортирует задачи по ключу keyOf(task); равные сохраняют исходный порядок
+    template<typename KeyFn>
+    static void sortByKey(QList<Task*> &tasks, KeyFn keyOf, bool ascending)
+    {
+        QVector<Entry> entries;
+        entries.reserve(tasks.size());
+        for (int i = 0; i < tasks.size(); ++i) {
+            quint64 key = keyOf(tasks.at(i));
+            Entry entry = { ascending ? key : ~key, quint32(i), tasks.at(i) };
+            entries.append(entry);
+        }
+        radixSort(entries);
+        for (int i = 0; i < entries.size(); ++i) {
+            tasks[i] = entries.at(i).task;
+        }
+    }
+
+private:
+    // На маленьких списках гистограммы дороже обычной сортировки
+    static const int RADIX_THRESHOLD = 64;
+};
+
+// Порядок задач по списку ключей (по умолчанию - незавершенные перед завершенными,
+// затем выбранный критерий), при равенстве всех ключей - по ID. Порядок строгий
+// и полный, поэтому по нему можно искать позицию задачи бинарным поиском
+class TaskSortOrder
+{
+public:
+    explicit TaskSortOrder(const TaskService::SortOptions &sortOpts);
+    explicit TaskSortOrder(const QList<SortKey> &keys);
+
+    bool operator()(const TaskSortKey &a, const TaskSortKey &b) const;
+    bool operator()(Task *a, Task *b) const;
+
+    // Сортирует список в этом порядке. Значения всех ключей задачи упаковываются
+    // в плоский ключ из слов по 64 бита; если он помещается в одно слово -
+    // сортировка поразрядная, иначе сравнение слов подряд
+    void sort(QList<Task*> &tasks) const;
+    // То же, что sort, но на chunkCount потоках: ключи строятся один раз,
+    // куски сортируются параллельно и сливаются попарно
+    void parallelSort(QList<Task*> &tasks, int chunkCount) const;
+    // Упорядочивает только первые count задач (для постраничного вывода)
+    void sortPrefix(QList<Task*> &tasks, int count) const;
+
+    const QList<SortKey> &keys() const { return m_keys; }
+
+private:
+    // Плоские ключи всех задач подряд: words слов на задачу, старшее слово первым
+    struct FlatKeys {
+        int words;
+        QVector<quint64> data;
+    };
+
+    // Сравнение задач по номерам в списке: слова плоских ключей, при равенстве - ID
+    // Хранит только указатели на данные и копируется в задачи пула потоков
+    class FlatLess {
+    public:
+        FlatLess(const FlatKeys &flat, const QVector<int> &ids)
+            : m_words(flat.words), m_data(flat.data.constData()), m_ids(ids.constData()) {}
+
+        bool operator()(int a, int b) const
+        {
+            const quint64 *ka = m_data + a * m_words;
+            const quint64 *kb = m_data + b * m_words;
+            for (int w = 0; w < m_words; ++w) {
+                if (ka[w] != kb[w]) {
+                    return ka[w] < kb[w];
+                }
+            }
+            return m_ids[a] < m_ids[b];
+        }
+
+    private:
+        int m_words;
+        const quint64 *m_data;
+        const int *m_ids;
+    };
+
+    FlatKeys flatten(const QList<Task*> &tasks) const;
+    void sortFlat(QList<Task*> &tasks, int count) const;
+    static int compareField(SortKey::Field field, const TaskSortKey &a, const TaskSortKey &b);
+
+    QList<SortKey> m_keys;
+};
+
+#endif // TASKSORTKEY_H
@@ -0,0 +1,165 @@
+#ifndef TASKSTREAM_H
+#define TASKSTREAM_H
+
+#include <QList>
+#include <QMap>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+class Task;
+
+// Ленивый конвейер запроса (pull-based)
+// Поток - это рецепт: генератор next(item) выдает следующий элемент или false в конце.
+// filter / map / take только оборачивают генератор; данные читаются, лишь когда
+// потребитель обходит поток (forEach, toList, groupBy, range-for). Каждый обход
+// начинается с копии генератора, поэтому поток из повторяемого источника можно
+// обходить несколько раз. Во время обхода источник менять нельзя
+template<typename T>
+class TaskStream
+{
+public:
+    typedef std::function<bool(T &)> Generator;
+
+    explicit TaskStream(const Generator &next) : m_next(next) {}
+
+    static TaskStream fromList(const QList<T> &items)
+    {
+        int index = 0;
+        return TaskStream([items, index](T &item) mutable -> bool {
+            if (index >= items.size()) {
+                return false;
+            }
+            item = items.at(index++);
+            return true;
+        });
+    }
+
+    template<typename Predicate>
+    TaskStream filter(Predicate predicate) const
+    {
+        Generator next = m_next;
+        return TaskStream([next, predicate](T &item) mutable -> bool {
+            while (next(item)) {
+                if (predicate(item)) {
+                    return true;
+                }
+            }
+            return false;
+        });
+    }
+
+    template<typename F>
+    TaskStream<typename std::decay<decltype(std::declval<F>()(std::declval<T>()))>::type> map(F f) const
+    {
+        typedef typename std::decay<decltype(std::declval<F>()(std::declval<T>()))>::type R;
+        Generator next = m_next;
+        return TaskStream<R>([next, f](R &out) mutable -> bool {
+            T item = T();
+            if (!next(item)) {
+                return false;
+            }
+            out = f(item);
+            return true;
+        });
+    }
+
+    // Не больше count элементов; источник дальше не читается
+    TaskStream take(int count) const
+    {
+        Generator next = m_next;
+        int taken = 0;
+        return TaskStream([next, count, taken](T &item) mutable -> bool {
+            if (taken >= count || !next(item)) {
+                return false;
+            }
+            ++taken;
+            return true;
+        });
+    }
+
+    // Потребители
+    template<typename F>
+    void forEach(F f) const
+    {
+        Generator next = m_next;
+        T item = T();
+        while (next(item)) {
+            f(item);
+        }
+    }
+
+    QList<T> toList() const
+    {
+        QList<T> result;
+        forEach([&result](const T &item) { result.append(item); });
+        return result;
+    }
+
+    int count() const
+    {
+        int total = 0;
+        forEach([&total](const T &) { ++total; });
+        return total;
+    }
+
+    // Группировка с материализацией групп
+    template<typename KeyFn>
+    QMap<typename std::decay<decltype(std::declval<KeyFn>()(std::declval<T>()))>::type, QList<T>>
+    groupBy(KeyFn keyOf) const
+    {
+        typedef typename std::decay<decltype(std::declval<KeyFn>()(std::declval<T>()))>::type K;
+        QMap<K, QList<T>> groups;
+        forEach([&groups, &keyOf](const T &item) { groups[keyOf(item)].append(item); });
+        return groups;
+    }
+
+    // Группировка со сверткой: в памяти только по одному аккумулятору на группу,
+    // например число задач по проектам при обходе миллионов задач
+    template<typename KeyFn, typename Acc, typename Fold>
+    QMap<typename std::decay<decltype(std::declval<KeyFn>()(std::declval<T>()))>::type, Acc>
+    groupBy(KeyFn keyOf, const Acc &initial, Fold fold) const
+    {
+        typedef typename std::decay<decltype(std::declval<KeyFn>()(std::declval<T>()))>::type K;
+        QMap<K, Acc> groups;
+        forEach([&](const T &item) {
+            K key = keyOf(item);
+            typename QMap<K, Acc>::iterator it = groups.find(key);
+            if (it == groups.end()) {
+                it = groups.insert(key, initial);
+            }
+            fold(it.value(), item);
+        });
+        return groups;
+    }
+
+    // Однопроходный итератор для range-for
+    class const_iterator
+    {
+    public:
+        const_iterator() : m_value(), m_done(true) {}
+        explicit const_iterator(const Generator &next) : m_next(next), m_value(), m_done(false) { advance(); }
+
+        const T &operator*() const { return m_value; }
+        const T *operator->() const { return &m_value; }
+        const_iterator &operator++() { advance(); return *this; }
+        // Итераторы сравниваются только с end()
+        bool operator==(const const_iterator &other) const { return m_done == other.m_done; }
+        bool operator!=(const const_iterator &other) const { return m_done != other.m_done; }
+
+    private:
+        void advance() { m_done = !m_next(m_value); }
+
+        Generator m_next;
+        T m_value;
+        bool m_done;
+    };
+
+    const_iterator begin() const { return const_iterator(m_next); }
+    const_iterator end() const { return const_iterator(); }
+
+private:
+    Generator m_next;
+};
+
+#endif // TASKSTREAM_H
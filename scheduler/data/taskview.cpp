@@ -0,0 +1,177 @@
+#include "taskview.h"
+#include "../models/task.h"
+
+TaskView::TaskView(TaskService *service, QObject *parent)
+    : QObject(parent),
+      m_taskService(service),
+      m_hasQuery(false),
+      m_pageSize(0),
+      m_hasMore(false)
+{
+    if (m_taskService) {
+        connect(m_taskService, &TaskService::taskAdded, this, &TaskView::onTaskAdded);
+        connect(m_taskService, &TaskService::taskRemoved, this, &TaskView::onTaskRemoved);
+        connect(m_taskService, &TaskService::taskUpdated, this, &TaskView::onTaskUpdated);
+        // Имена проектов участвуют в сортировке и отображении, а после очистки
+        // данных сохраненные указатели недействительны - перестраиваем целиком
+        connect(m_taskService, &TaskService::catalogChanged, this, &TaskView::reload);
+    }
+}
+
+void TaskView::setQuery(const TaskService::FilterOptions &filterOpts, const TaskService::SortOptions &sortOpts)
+{
+    if (m_hasQuery && m_filterOpts == filterOpts && m_sortOpts == sortOpts) {
+        return;
+    }
+    m_filterOpts = filterOpts;
+    m_sortOpts = sortOpts;
+    m_hasQuery = true;
+    reload();
+}
+
+void TaskView::reload()
+{
+    if (!m_hasQuery || !m_taskService) {
+        return;
+    }
+    if (m_pageSize > 0) {
+        TaskService::TaskPage page = m_taskService->getFilteredAndSortedTasks(
+            m_filterOpts, m_sortOpts, TaskService::Cursor(), m_pageSize);
+        m_tasks = page.tasks;
+        m_hasMore = !page.next.isNull();
+    } else {
+        m_tasks = m_taskService->getFilteredAndSortedTasks(m_filterOpts, m_sortOpts);
+        m_hasMore = false;
+    }
+    m_keyOf.clear();
+    m_keyOf.reserve(m_tasks.size());
+    for (Task *task : m_tasks) {
+        m_keyOf.insert(task, TaskSortKey::fromTask(task));
+    }
+    emit reset();
+}
+
+void TaskView::fetchMore()
+{
+    if (!m_hasQuery || !m_hasMore || !m_taskService) {
+        return;
+    }
+    // Продолжаем с последней строки окна по ключу, а не по смещению: задачи,
+    // вытесненные за окно, идут после нее и попадут в следующую страницу
+    TaskService::Cursor after = m_tasks.isEmpty() ? TaskService::Cursor()
+                                                  : TaskService::cursorAfter(m_tasks.last(), m_sortOpts);
+    TaskService::TaskPage page = m_taskService->getFilteredAndSortedTasks(m_filterOpts, m_sortOpts,
+                                                                        after, m_pageSize);
+    m_hasMore = !page.next.isNull();
+    for (Task *task : page.tasks) {
+        m_tasks.append(task);
+        m_keyOf.insert(task, TaskSortKey::fromTask(task));
+        emit rowInserted(m_tasks.size() - 1);
+    }
+}
+
+int TaskView::rowOf(Task *task) const
+{
+    QHash<Task*, TaskSortKey>::const_iterator it = m_keyOf.constFind(task);
+    if (it == m_keyOf.constEnd()) {
+        return -1;
+    }
+    int row = lowerBound(it.value());
+    return row < m_tasks.size() && m_tasks.at(row) == task ? row : -1;
+}
+
+void TaskView::onTaskAdded(Task *task)
+{
+    if (!m_hasQuery || !m_taskService->matchesFilter(task, m_filterOpts)) {
+        return;
+    }
+    insertTask(task, TaskSortKey::fromTask(task));
+}
+
+void TaskView::onTaskRemoved(Task *task)
+{
+    int row = rowOf(task);
+    if (row < 0) {
+        return;
+    }
+    m_tasks.removeAt(row);
+    m_keyOf.remove(task);
+    emit rowRemoved(row);
+}
+
+void TaskView::onTaskUpdated(Task *task)
+{
+    if (!m_hasQuery) {
+        return;
+    }
+    int row = rowOf(task);
+    bool matches = m_taskService->matchesFilter(task, m_filterOpts);
+
+    if (row < 0) {
+        // Задача могла начать подходить под фильтры после изменения
+        if (matches) {
+            insertTask(task, TaskSortKey::fromTask(task));
+        }
+        return;
+    }
+    if (!matches) {
+        m_tasks.removeAt(row);
+        m_keyOf.remove(task);
+        emit rowRemoved(row);
+        return;
+    }
+
+    // Задача остается в списке - ищем новое место по новому ключу
+    // Поиск идет по списку вместе с задачей: ее старый ключ сдвигает найденную
+    // позицию на одну строку, только если он меньше нового
+    TaskSortKey key = TaskSortKey::fromTask(task);
+    int newRow = lowerBound(key);
+    if (TaskSortOrder(m_sortOpts)(m_keyOf.value(task), key)) {
+        --newRow;
+    }
+    if (m_hasMore && newRow == m_tasks.size() - 1) {
+        // Задача ушла за пределы окна
+        m_tasks.removeAt(row);
+        m_keyOf.remove(task);
+        emit rowRemoved(row);
+        return;
+    }
+    // Сдвигаются только строки между старой и новой позицией
+    m_tasks.move(row, newRow);
+    m_keyOf.insert(task, key);
+    if (newRow == row) {
+        emit rowChanged(row);
+    } else {
+        emit rowMoved(row, newRow);
+    }
+}
+
+// Первая позиция, ключ на которой не меньше key (порядок строгий и полный,
+// поэтому для задачи из списка это ровно ее позиция)
+int TaskView::lowerBound(const TaskSortKey &key) const
+{
+    TaskSortOrder less(m_sortOpts);
+    int lo = 0;
+    int hi = m_tasks.size();
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (less(m_keyOf.value(m_tasks.at(mid)), key)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void TaskView::insertTask(Task *task, const TaskSortKey &key)
+{
+    int row = lowerBound(key);
+    // За последней строкой неполного окна задача окажется в следующих страницах
+    if (m_hasMore && row == m_tasks.size()) {
+        return;
+    }
+    m_tasks.insert(row, task);
+    m_keyOf.insert(task, key);
+    emit rowInserted(row);
+}
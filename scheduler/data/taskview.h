@@ -0,0 +1,82 @@
+#ifndef TASKVIEW_H
+#define TASKVIEW_H
+
+#include "taskservice.h"
+#include "tasksortkey.h"
+#include <QObject>
+#include <QList>
+#include <QHash>
+
+class Task;
+
+// Живое представление списка задач (incremental view maintenance)
+// Хранит текущие фильтры и сортировку и поддерживает результат в актуальном
+// состоянии по сигналам TaskService: место добавленной или измененной задачи
+// находится бинарным поиском (O(log n) сравнений ключей), наружу уходят
+// построчные уведомления вместо полного перестроения списка.
+// Вставка, удаление и перемещение в QList сдвигают указатели между позициями -
+// O(n) в худшем случае, но это memmove без сравнений и без обращения к задачам;
+// строки виджета сдвигаются так же
+class TaskView : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TaskView(TaskService *service, QObject *parent = nullptr);
+
+    // Перестраивает представление, только если фильтры или сортировка изменились
+    void setQuery(const TaskService::FilterOptions &filterOpts, const TaskService::SortOptions &sortOpts);
+    // Полное перестроение по текущему запросу
+    void reload();
+
+    // Размер окна: представление держит только первые строки результата и
+    // расширяется по fetchMore. 0 - весь результат сразу
+    void setPageSize(int pageSize) { m_pageSize = pageSize; }
+    int pageSize() const { return m_pageSize; }
+    bool canFetchMore() const { return m_hasMore; }
+    // Догружает следующую страницу в конец окна
+    void fetchMore();
+
+    const TaskService::FilterOptions &filterOptions() const { return m_filterOpts; }
+    const TaskService::SortOptions &sortOptions() const { return m_sortOpts; }
+
+    const QList<Task*> &tasks() const { return m_tasks; }
+    int count() const { return m_tasks.size(); }
+    Task* at(int row) const { return m_tasks.at(row); }
+    int rowOf(Task *task) const;
+
+signals:
+    // Список перестроен целиком
+    void reset();
+    void rowInserted(int row);
+    void rowRemoved(int row);
+    // Задача перемещена; to - позиция в списке уже после перемещения
+    void rowMoved(int from, int to);
+    // Задача осталась на месте, но ее данные изменились
+    void rowChanged(int row);
+
+private slots:
+    void onTaskAdded(Task *task);
+    void onTaskRemoved(Task *task);
+    void onTaskUpdated(Task *task);
+
+private:
+    int lowerBound(const TaskSortKey &key) const;
+    void insertTask(Task *task, const TaskSortKey &key);
+
+    TaskService *m_taskService;
+    TaskService::FilterOptions m_filterOpts;
+    TaskService::SortOptions m_sortOpts;
+    bool m_hasQuery;
+    int m_pageSize;
+    // За окном есть еще задачи. Окно всегда точный префикс полного результата,
+    // поэтому следующая страница запрашивается по курсору после последней строки
+    bool m_hasMore;
+
+    QList<Task*> m_tasks;
+    // Ключ, с которым задача стоит в списке: поля задачи к моменту сигнала уже
+    // изменены, а старую позицию нужно найти по старым значениям
+    QHash<Task*, TaskSortKey> m_keyOf;
+};
+
+#endif // TASKVIEW_H
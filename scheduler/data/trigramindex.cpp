@@ -0,0 +1,153 @@
+#include "trigramindex.h"
+#include "slotstore.h"
+#include <algorithm>
+
+void TrigramIndex::insert(int slot, const QString &foldedText)
+{
+    for (quint64 gram : grams(foldedText)) {
+        QVector<int> &postings = m_postings[gram];
+        // Новые задачи получают наибольший слот - обычно это просто добавление в конец
+        if (postings.isEmpty() || postings.last() < slot) {
+            postings.append(slot);
+        } else {
+            QVector<int>::iterator it = std::lower_bound(postings.begin(), postings.end(), slot);
+            if (it == postings.end() || *it != slot) {
+                postings.insert(it, slot);
+            }
+        }
+    }
+}
+
+void TrigramIndex::remove(int slot, const QString &foldedText)
+{
+    for (quint64 gram : grams(foldedText)) {
+        QHash<quint64, QVector<int>>::iterator postingsIt = m_postings.find(gram);
+        if (postingsIt == m_postings.end()) {
+            continue;
+        }
+        QVector<int> &postings = postingsIt.value();
+        QVector<int>::iterator it = std::lower_bound(postings.begin(), postings.end(), slot);
+        if (it != postings.end() && *it == slot) {
+            postings.erase(it);
+        }
+        if (postings.isEmpty()) {
+            m_postings.erase(postingsIt);
+        }
+    }
+}
+
+void TrigramIndex::remap(const QVector<int> &slots)
+{
+    for (QHash<quint64, QVector<int>>::iterator it = m_postings.begin(); it != m_postings.end();) {
+        remapSlots(it.value(), slots);
+        if (it.value().isEmpty()) {
+            it = m_postings.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+QVector<int> TrigramIndex::candidates(const QString &foldedQuery) const
+{
+    QVector<const QVector<int>*> lists;
+    for (quint64 gram : queryGrams(foldedQuery)) {
+        QHash<quint64, QVector<int>>::const_iterator it = m_postings.constFind(gram);
+        if (it == m_postings.constEnd()) {
+            return QVector<int>(); // Триграммы нет ни в одном названии
+        }
+        lists.append(&it.value());
+    }
+    if (lists.isEmpty()) {
+        return QVector<int>();
+    }
+    
+    // Пересекаем, начиная с самого короткого списка - результат не длиннее него
+    std::sort(lists.begin(), lists.end(), [](const QVector<int> *a, const QVector<int> *b) {
+        return a->size() < b->size();
+    });
+    
+    QVector<int> result = *lists.first();
+    for (int i = 1; i < lists.size() && !result.isEmpty(); ++i) {
+        const QVector<int> &other = *lists.at(i);
+        QVector<int> intersection;
+        intersection.reserve(result.size());
+        // Списки отсортированы: для каждого кандидата ищем его бинарным поиском
+        // в более длинном списке, сдвигая нижнюю границу вперед
+        QVector<int>::const_iterator from = other.constBegin();
+        for (int slot : result) {
+            from = std::lower_bound(from, other.constEnd(), slot);
+            if (from == other.constEnd()) {
+                break;
+            }
+            if (*from == slot) {
+                intersection.append(slot);
+            }
+        }
+        result = intersection;
+    }
+    return result;
+}
+
+int TrigramIndex::estimate(const QString &foldedQuery) const
+{
+    int best = -1;
+    for (quint64 gram : queryGrams(foldedQuery)) {
+        int size = m_postings.value(gram).size();
+        if (best < 0 || size < best) {
+            best = size;
+        }
+        if (best == 0) {
+            break;
+        }
+    }
+    return qMax(best, 0);
+}
+
+// Символы n-граммы упаковываются по 16 бит, длина 1 и 2 помечается в старших битах,
+// чтобы пара или символ не совпали с триграммой, начинающейся с нулевых символов
+quint64 TrigramIndex::gram(const QChar *data, int length)
+{
+    quint64 result = length < GRAM_SIZE ? quint64(length) << 48 : 0;
+    for (int i = 0; i < length; ++i) {
+        result |= quint64(data[i].unicode()) << (16 * (length - 1 - i));
+    }
+    return result;
+}
+
+QVector<quint64> TrigramIndex::grams(const QString &text)
+{
+    QVector<quint64> result;
+    if (text.isEmpty()) {
+        return result;
+    }
+    result.reserve(text.size() * GRAM_SIZE);
+    const QChar *data = text.constData();
+    for (int length = 1; length <= GRAM_SIZE; ++length) {
+        for (int i = 0; i + length <= text.size(); ++i) {
+            result.append(gram(data + i, length));
+        }
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+QVector<quint64> TrigramIndex::queryGrams(const QString &text)
+{
+    QVector<quint64> result;
+    const QChar *data = text.constData();
+    if (text.size() < GRAM_SIZE) {
+        if (!text.isEmpty()) {
+            result.append(gram(data, text.size()));
+        }
+        return result;
+    }
+    result.reserve(text.size() - GRAM_SIZE + 1);
+    for (int i = 0; i + GRAM_SIZE <= text.size(); ++i) {
+        result.append(gram(data + i, GRAM_SIZE));
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
@@ -0,0 +1,45 @@
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <QString>
+#include <QHash>
+#include <QVector>
+
+// Инвертированный индекс триграмм для поиска подстроки в названиях задач
+// Текст приводится к свернутому регистру (toCaseFolded), каждая тройка
+// подряд идущих символов UTF-16 отображается в отсортированный список слотов.
+// Кандидаты для подстроки - пересечение списков всех ее триграмм.
+// Отдельные символы и пары символов тоже индексируются, чтобы запросы
+// короче триграммы не просматривали все названия: для них список - точный ответ
+class TrigramIndex
+{
+public:
+    static const int GRAM_SIZE = 3;
+    
+    static QString fold(const QString &text) { return text.toCaseFolded(); }
+    
+    void insert(int slot, const QString &foldedText);
+    void remove(int slot, const QString &foldedText);
+    void clear() { m_postings.clear(); }
+    // Перенумерация слотов после уплотнения хранилища (см. SlotStore::compact)
+    void remap(const QVector<int> &slots);
+    
+    // Отсортированные слоты, содержащие все триграммы запроса
+    // Запрос должен быть в свернутом регистре и не пустым; кандидаты запроса
+    // от GRAM_SIZE символов нужно проверить, т.к. наличие всех триграмм
+    // не гарантирует вхождение, а более короткий запрос дает точный ответ
+    QVector<int> candidates(const QString &foldedQuery) const;
+    // Верхняя оценка числа кандидатов - длина самого короткого списка триграмм запроса
+    int estimate(const QString &foldedQuery) const;
+
+private:
+    // Все уникальные n-граммы текста длиной от 1 до GRAM_SIZE
+    static QVector<quint64> grams(const QString &text);
+    // n-граммы для поиска: триграммы запроса или сам короткий запрос
+    static QVector<quint64> queryGrams(const QString &text);
+    static quint64 gram(const QChar *data, int length);
+    
+    QHash<quint64, QVector<int>> m_postings;
+};
+
+#endif // TRIGRAMINDEX_H
@@ -12,40 +12,45 @@ void UserRepository::add(User *user)
         if (user->getId() < 0) {
             user->setId(m_nextUserId++);
         }
-        m_users.append(user);
+        m_users.insert(user);
+        m_byName.insert(user);
     }
 }
 
 void UserRepository::remove(User *user)
 {
-    m_users.removeAll(user);
+    if (m_users.take(user) >= 0) {
+        m_byName.remove(user);
+        if (m_users.isSparse()) {
+            m_users.compact();
+        }
+    }
 }
 
 User* UserRepository::findById(int id) const
 {
-    for (User *user : m_users) {
-        if (user->getId() == id) {
-            return user;
-        }
-    }
-    return nullptr;
+    return m_users.findById(id);
 }
 
 void UserRepository::clear()
 {
     m_users.clear();
+    m_byName.clear();
     m_nextUserId = 1;
 }
 
 User* UserRepository::findByName(const QString &name) const
 {
-    for (User *user : m_users) {
-        if (user->getName() == name) {
-            return user;
-        }
-    }
-    return nullptr;
+    return m_byName.find(name);
 }
 
-
-
+void UserRepository::rename(User *user, const QString &name)
+{
+    if (!user) {
+        return;
+    }
+    user->setName(name);
+    if (m_users.contains(user)) {
+        m_byName.update(user);
+    }
+}
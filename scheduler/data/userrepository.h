@@ -2,6 +2,8 @@
 #define USERREPOSITORY_H
 
 #include "repositories.h"
+#include "slotstore.h"
+#include "nameindex.h"
 #include <QObject>
 
 class UserRepository : public QObject, public IUserRepository
@@ -14,18 +16,21 @@ public:
     // IRepository interface
     void add(User *user) override;
     void remove(User *user) override;
-    QList<User*> getAll() const override { return m_users; }
+    QList<User*> getAll() const override { return m_users.items(); }
     User* findById(int id) const override;
     void clear() override;
     
     // IUserRepository interface
     User* findByName(const QString &name) const override;
+    void rename(User *user, const QString &name) override;
+    QStringList completeName(const QString &prefix, int limit) const override { return m_byName.complete(prefix, limit); }
     
     int getNextId() { return m_nextUserId++; }
     void setNextId(int id) { m_nextUserId = id; }
 
 private:
-    QList<User*> m_users;
+    SlotStore<User> m_users;
+    NameIndex<User> m_byName;
     int m_nextUserId;
 };
 
@@ -10,6 +10,8 @@ ReminderManager::ReminderManager(TaskService *taskService, QObject *parent)
     if (m_taskService) {
         connect(m_taskService, &TaskService::taskAdded, this, &ReminderManager::onTaskAdded);
         connect(m_taskService, &TaskService::taskRemoved, this, &ReminderManager::onTaskRemoved);
+        // Одно соединение на все задачи вместо соединения с каждой задачей
+        connect(m_taskService, &TaskService::taskFieldsChanged, this, &ReminderManager::onTaskFieldsChanged);
     }
 }
 
@@ -39,9 +41,6 @@ void ReminderManager::addReminder(Task *task, int minutesBeforeDeadline)
     
     m_reminders.append(reminder);
     reminder->activate(); // Запускаем таймер
-    
-    // Подключаемся к сигналам задачи для отслеживания изменений
-    connectTaskSignals(task);
 }
 
 void ReminderManager::removeReminder(Task *task)
@@ -63,6 +62,25 @@ void ReminderManager::removeAllReminders()
     m_reminders.clear();
 }
 
+// Восстанавливает напоминания при запуске
+// Берет из индекса дедлайнов только незавершенные задачи, для которых таймер
+// может быть запущен: QTimer не заводится дальше ~24 дней, плюс наибольшее
+// упреждение напоминания среди незавершенных задач (при импорте оно может
+// быть больше недели, допустимой в редакторе) - его ведет репозиторий
+void ReminderManager::restoreReminders()
+{
+    removeAllReminders();
+    if (!m_taskService) {
+        return;
+    }
+    
+    qint64 maxMinutes = m_taskService->getMaxReminderMinutes();
+    QDateTime horizon = QDateTime::currentDateTime().addMSecs(2147483647LL).addSecs(maxMinutes * 60);
+    for (Task *task : m_taskService->getTasksDueBetween(QDateTime(), horizon, true)) {
+        addReminder(task, task->getReminderMinutes());
+    }
+}
+
 Reminder* ReminderManager::findReminderByTask(Task *task) const
 {
     for (Reminder *reminder : m_reminders) {
@@ -117,31 +135,30 @@ void ReminderManager::onTaskRemoved(Task *task)
     }
 }
 
-// Подключается к сигналу taskChanged для автоматического обновления напоминания
-// при изменении дедлайна или статуса задачи
-void ReminderManager::connectTaskSignals(Task *task)
+// Обновляет напоминание при изменении дедлайна, статуса или упреждения задачи
+// Изменения остальных полей на время срабатывания не влияют. Незавершенная задача
+// без напоминания (например, без дедлайна при загрузке или за горизонтом таймера)
+// получает его здесь, как при добавлении
+void ReminderManager::onTaskFieldsChanged(int taskId, Task::Fields fields)
 {
+    if (!(fields & (Task::DeadlineField | Task::CompletedField | Task::ReminderField)) || !m_taskService) {
+        return;
+    }
+    Task *task = m_taskService->findTaskById(taskId);
     if (!task) {
         return;
     }
-    
-    connect(task, &Task::taskChanged, this, [this, task]() {
-        Reminder *reminder = findReminderByTask(task);
-        if (reminder) {
-            if (task->isCompleted()) {
-                // Удаляем напоминание для завершенных задач
-                removeReminder(task);
-            } else {
-                // Пересоздаем напоминание при изменении задачи (например, дедлайна)
-                int reminderMinutes = task->getReminderMinutes();
-                if (reminderMinutes < 2) {
-                    reminderMinutes = 2;
-                }
-                removeReminder(task);
-                addReminder(task, reminderMinutes);
-            }
+    if (task->isCompleted()) {
+        // Удаляем напоминание для завершенных задач
+        removeReminder(task);
+    } else {
+        // Пересоздаем напоминание при изменении задачи (например, дедлайна);
+        // addReminder сам снимает старое
+        int reminderMinutes = task->getReminderMinutes();
+        if (reminderMinutes < 2) {
+            reminderMinutes = 2;
         }
-    });
+        addReminder(task, reminderMinutes);
+    }
 }
 
-
@@ -4,8 +4,8 @@
 #include <QObject>
 #include <QList>
 #include "../models/reminder.h"
+#include "../models/task.h"
 
-class Task;
 class TaskService;
 
 // Менеджер напоминаний (Observer Pattern)
@@ -22,6 +22,9 @@ public:
     void removeReminder(Task *task);
     void removeAllReminders();
     
+    // Пересоздает напоминания для всех незавершенных задач, которые могут сработать
+    void restoreReminders();
+    
     Reminder* findReminderByTask(Task *task) const;
 
 signals:
@@ -31,11 +34,11 @@ private slots:
     void onReminderTriggered(Reminder *reminder);
     void onTaskAdded(Task *task);
     void onTaskRemoved(Task *task);
+    void onTaskFieldsChanged(int taskId, Task::Fields fields);
 
 private:
     TaskService *m_taskService;
     QList<Reminder*> m_reminders;
-    void connectTaskSignals(Task *task);
 };
 
 #endif // REMINDERMANAGER_H
@@ -1,11 +1,16 @@
 #include "task.h"
 #include "project.h"
 #include "user.h"
+#include "taskchangedispatcher.h"
+#include <QCollator>
+#include <QLocale>
 
 Task::Task(const QString &title, const QDateTime &deadline, Priority priority,
            User *owner, Project *project, int id, int reminderMinutes)
-    : m_id(id), m_title(title), m_deadline(deadline), m_priority(priority),
-      m_completed(false), m_owner(owner), m_project(project), m_reminderMinutes(reminderMinutes)
+    : m_id(id), m_title(title), m_titleSortKey(collationKey(title)), m_foldedTitle(title.toCaseFolded()),
+      m_deadline(deadline), m_priority(priority),
+      m_completed(false), m_owner(owner), m_project(project), m_reminderMinutes(reminderMinutes),
+      m_dispatcher(nullptr)
 {
     // Автоматически добавляем задачу в список задач пользователя (двунаправленная связь)
     if (m_owner) {
@@ -13,11 +18,22 @@ Task::Task(const QString &title, const QDateTime &deadline, Priority priority,
     }
 }
 
+// Коллатор локали приложения: кириллица и регистр упорядочиваются по правилам языка,
+// а не по кодам UTF-16
+QCollatorSortKey Task::collationKey(const QString &text)
+{
+    static QCollator collator(QLocale::system());
+    return collator.sortKey(text);
+}
+
 void Task::setTitle(const QString &title)
 {
     if (m_title != title) {
+        notifyAboutToChange(TitleField);
         m_title = title;
-        emit taskChanged();
+        m_titleSortKey = collationKey(title);
+        m_foldedTitle = title.toCaseFolded();
+        notifyChanged(TitleField);
     }
 }
 
@@ -25,7 +41,7 @@ void Task::setDeadline(const QDateTime &deadline)
 {
     if (m_deadline != deadline) {
         m_deadline = deadline;
-        emit taskChanged();
+        notifyChanged(DeadlineField);
     }
 }
 
@@ -33,7 +49,7 @@ void Task::setPriority(Priority priority)
 {
     if (m_priority != priority) {
         m_priority = priority;
-        emit taskChanged();
+        notifyChanged(PriorityField);
     }
 }
 
@@ -41,7 +57,7 @@ void Task::setCompleted(bool completed)
 {
     if (m_completed != completed) {
         m_completed = completed;
-        emit taskChanged();
+        notifyChanged(CompletedField);
     }
 }
 
@@ -56,7 +72,7 @@ void Task::setOwner(User *owner)
         if (m_owner) {
             m_owner->addTask(this);
         }
-        emit taskChanged();
+        notifyChanged(OwnerField);
     }
 }
 
@@ -64,7 +80,7 @@ void Task::setProject(Project *project)
 {
     if (m_project != project) {
         m_project = project;
-        emit taskChanged();
+        notifyChanged(ProjectField);
     }
 }
 
@@ -72,7 +88,7 @@ void Task::setDescription(const QString &description)
 {
     if (m_description != description) {
         m_description = description;
-        emit taskChanged();
+        notifyChanged(DescriptionField);
     }
 }
 
@@ -83,7 +99,21 @@ void Task::setReminderMinutes(int minutes)
     }
     if (m_reminderMinutes != minutes) {
         m_reminderMinutes = minutes;
-        emit taskChanged();
+        notifyChanged(ReminderField);
+    }
+}
+
+void Task::notifyAboutToChange(Field field)
+{
+    if (m_dispatcher) {
+        m_dispatcher->aboutToChange(this, field);
+    }
+}
+
+void Task::notifyChanged(Field field)
+{
+    if (m_dispatcher) {
+        m_dispatcher->notify(this, field);
     }
 }
 
@@ -3,10 +3,12 @@
 
 #include <QString>
 #include <QDateTime>
-#include <QObject>
+#include <QFlags>
+#include <QCollatorSortKey>
 
 class Project;
 class User;
+class TaskChangeDispatcher;
 
 // Приоритет задачи
 enum class Priority {
@@ -16,12 +18,24 @@ enum class Priority {
 };
 
 // Модель задачи - основная сущность приложения
-// Наследуется от QObject для поддержки сигналов/слотов Qt
-class Task : public QObject
+// Обычный класс без QObject: у задачи нет собственных сигналов, сеттеры сообщают
+// об изменении диспетчеру репозитория, в котором она хранится (TaskChangeDispatcher)
+class Task
 {
-    Q_OBJECT
-
 public:
+    // Поля задачи - маска изменений в уведомлениях диспетчера
+    enum Field {
+        TitleField = 0x01,
+        DescriptionField = 0x02,
+        DeadlineField = 0x04,
+        PriorityField = 0x08,
+        CompletedField = 0x10,
+        OwnerField = 0x20,
+        ProjectField = 0x40,
+        ReminderField = 0x80
+    };
+    Q_DECLARE_FLAGS(Fields, Field)
+    
     Task(const QString &title, const QDateTime &deadline, Priority priority, 
          User *owner, Project *project = nullptr, int id = -1, int reminderMinutes = 60);
     
@@ -29,6 +43,14 @@ public:
     void setId(int id) { m_id = id; }
     QString getTitle() const { return m_title; }
     void setTitle(const QString &title);
+    // Ключ сопоставления названия по правилам локали; вычисляется один раз
+    // и пересчитывается только в setTitle. Сравнение ключей - побайтовое
+    QCollatorSortKey getTitleSortKey() const { return m_titleSortKey; }
+    // Ключ сопоставления произвольной строки тем же коллатором
+    static QCollatorSortKey collationKey(const QString &text);
+    // Название в свернутом регистре (toCaseFolded) для поиска без учета регистра;
+    // как и ключ сопоставления, пересчитывается только в setTitle
+    const QString &getFoldedTitle() const { return m_foldedTitle; }
     
     QDateTime getDeadline() const { return m_deadline; }
     void setDeadline(const QDateTime &deadline);
@@ -53,14 +75,25 @@ public:
     
     static QString priorityToString(Priority priority);
     static Priority stringToPriority(const QString &str);
-
-signals:
-    // Эмитируется при любом изменении задачи (для обновления UI и напоминаний)
-    void taskChanged();
+    
+    // Диспетчер уведомлений; назначается репозиторием при добавлении задачи,
+    // у задачи вне репозитория его нет и изменения никому не сообщаются
+    TaskChangeDispatcher* getDispatcher() const { return m_dispatcher; }
+    void setDispatcher(TaskChangeDispatcher *dispatcher) { m_dispatcher = dispatcher; }
 
 private:
+    Q_DISABLE_COPY(Task)
+    
+    void notifyAboutToChange(Field field);
+    void notifyChanged(Field field);
+    
     int m_id;
     QString m_title;
+    // Кеши названия для сортировки и поиска: при названии из 33 символов
+    // свернутая строка занимает около 107 байт кучи, ключ ICU - около 129
+    // (Qt 5.15, замер - benchmarks/taskmemory)
+    QCollatorSortKey m_titleSortKey;
+    QString m_foldedTitle;
     QString m_description;
     QDateTime m_deadline;
     Priority m_priority;
@@ -68,8 +101,11 @@ private:
     User *m_owner;
     Project *m_project;
     int m_reminderMinutes;
+    TaskChangeDispatcher *m_dispatcher;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(Task::Fields)
+
 #endif // TASK_H
 
 
@@ -0,0 +1,24 @@
+#include "taskchangedispatcher.h"
+
+TaskChangeDispatcher::TaskChangeDispatcher(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void TaskChangeDispatcher::aboutToChange(Task *task, Task::Fields fields)
+{
+    if (task && m_aboutToChangeHandler) {
+        m_aboutToChangeHandler(task, fields);
+    }
+}
+
+void TaskChangeDispatcher::notify(Task *task, Task::Fields fields)
+{
+    if (!task) {
+        return;
+    }
+    if (m_handler) {
+        m_handler(task, fields);
+    }
+    emit taskChanged(task->getId(), fields);
+}
@@ -0,0 +1,38 @@
+#ifndef TASKCHANGEDISPATCHER_H
+#define TASKCHANGEDISPATCHER_H
+
+#include <QObject>
+#include <functional>
+#include "task.h"
+
+// Единая точка уведомлений об изменениях задач одного репозитория
+// Задачи не являются QObject и не держат собственных соединений: сеттер Task
+// передает диспетчеру себя и измененное поле. Сначала вызывается обработчик
+// владельца (репозиторий обновляет индексы), затем всем подписчикам -
+// сигнал taskChanged с ID задачи и маской полей.
+// Перед изменением поля, индекс которого хранит производные от старого значения
+// (название), сеттер вызывает aboutToChange: владелец убирает задачу из индексов,
+// пока старое значение еще доступно, и не держит его отдельной копии
+class TaskChangeDispatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<void(Task *task, Task::Fields fields)> Handler;
+    
+    explicit TaskChangeDispatcher(QObject *parent = nullptr);
+    
+    void setHandler(const Handler &handler) { m_handler = handler; }
+    void setAboutToChangeHandler(const Handler &handler) { m_aboutToChangeHandler = handler; }
+    void aboutToChange(Task *task, Task::Fields fields);
+    void notify(Task *task, Task::Fields fields);
+
+signals:
+    void taskChanged(int taskId, Task::Fields fields);
+
+private:
+    Handler m_handler;
+    Handler m_aboutToChangeHandler;
+};
+
+#endif // TASKCHANGEDISPATCHER_H
@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui
+QT       += core gui concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -30,6 +30,7 @@ SOURCES += \
         models/user.cpp \
         models/project.cpp \
         models/reminder.cpp \
+        models/taskchangedispatcher.cpp \
         managers/command.cpp \
         managers/remindermanager.cpp \
         ui/mainwindow.cpp \
@@ -38,17 +39,31 @@ SOURCES += \
         ui/projectmanager.cpp \
         ui/tasklistwidget.cpp \
         ui/appstyles.cpp \
+        ui/suggestions.cpp \
         data/taskrepository.cpp \
         data/userrepository.cpp \
         data/projectrepository.cpp \
         data/taskservice.cpp \
-        data/strategies.cpp
+        data/strategies.cpp \
+        data/trigramindex.cpp \
+        data/slotbitmap.cpp \
+        data/queryplanner.cpp \
+        data/tasksortkey.cpp \
+        data/taskview.cpp \
+        data/jsonarrayreader.cpp \
+        data/querycompiler.cpp \
+        data/casefoldsearch.cpp \
+        data/fulltextindex.cpp \
+        data/fuzzyindex.cpp \
+        data/completionindex.cpp \
+        data/duplicateindex.cpp
 
 HEADERS += \
         models/task.h \
         models/user.h \
         models/project.h \
         models/reminder.h \
+        models/taskchangedispatcher.h \
         managers/command.h \
         managers/remindermanager.h \
         ui/mainwindow.h \
@@ -57,12 +72,30 @@ HEADERS += \
         ui/projectmanager.h \
         ui/tasklistwidget.h \
         ui/appstyles.h \
+        ui/suggestions.h \
         data/repositories.h \
+        data/slotstore.h \
+        data/nameindex.h \
+        data/generationcache.h \
         data/strategies.h \
+        data/filtercombinators.h \
         data/taskrepository.h \
         data/userrepository.h \
         data/projectrepository.h \
-        data/taskservice.h
+        data/taskservice.h \
+        data/trigramindex.h \
+        data/slotbitmap.h \
+        data/queryplanner.h \
+        data/tasksortkey.h \
+        data/taskview.h \
+        data/taskstream.h \
+        data/jsonarrayreader.h \
+        data/querycompiler.h \
+        data/casefoldsearch.h \
+        data/fulltextindex.h \
+        data/fuzzyindex.h \
+        data/completionindex.h \
+        data/duplicateindex.h
 
 FORMS += \
         ui/mainwindow.ui
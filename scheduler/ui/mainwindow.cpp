@@ -4,6 +4,7 @@
 #include "projectmanager.h"
 #include "tasklistwidget.h"
 #include "appstyles.h"
+#include "suggestions.h"
 #include "../managers/command.h"
 #include "../models/task.h"
 #include "../models/project.h"
@@ -100,12 +101,7 @@ MainWindow::MainWindow(QWidget *parent)
     
     // Восстанавливаем напоминания для всех незавершенных задач
     if (m_reminderManager) {
-        m_reminderManager->removeAllReminders();
-        for (Task *task : m_taskService->getAllTasks()) {
-            if (!task->isCompleted()) {
-                m_reminderManager->addReminder(task, task->getReminderMinutes());
-            }
-        }
+        m_reminderManager->restoreReminders();
     }
     
     setWindowTitle("Планировщик задач");
@@ -119,8 +115,11 @@ MainWindow::~MainWindow()
 
 void MainWindow::setupUI()
 {
-    searchEdit->setPlaceholderText("Введите название задачи...");
+    searchEdit->setPlaceholderText("Название или запрос: owner:\"Иван Иванов\" priority>=medium due<2026-11-01 !is:done");
     connect(searchEdit, &QLineEdit::textChanged, this, &MainWindow::onSearchTextChanged);
+    Suggestions::install(searchEdit, [this](const QString &text) {
+        return m_taskService ? m_taskService->completeTitle(text) : QStringList();
+    });
     
     priorityFilter->addItem("Все", -1);
     priorityFilter->addItem("Низкий", static_cast<int>(Priority::Low));
@@ -233,6 +232,7 @@ void MainWindow::setupMenuBar()
     QMenu *toolsMenu = QMainWindow::menuBar()->addMenu("Инструменты");
     toolsMenu->addAction("Управление пользователями...", this, &MainWindow::onUserManager);
     toolsMenu->addAction("Управление проектами...", this, &MainWindow::onProjectManager);
+    toolsMenu->addAction("Похожие задачи...", this, &MainWindow::onFindDuplicates);
 }
 
 void MainWindow::setupToolBar()
@@ -299,6 +299,30 @@ void MainWindow::onProjectManager()
     showProjectManagerDialog();
 }
 
+// Отчет о группах почти одинаковых задач - кандидатах на объединение
+void MainWindow::onFindDuplicates()
+{
+    const int maxShown = 20;
+    QList<QList<Task*>> clusters = m_taskService->findNearDuplicateClusters();
+    if (clusters.isEmpty()) {
+        QMessageBox::information(this, "Похожие задачи", "Похожих задач не найдено");
+        return;
+    }
+    QStringList lines;
+    for (int i = 0; i < clusters.size() && i < maxShown; ++i) {
+        QStringList titles;
+        for (Task *task : clusters.at(i)) {
+            titles.append(task->getTitle());
+        }
+        lines.append(QString("• %1").arg(titles.join(" / ")));
+    }
+    if (clusters.size() > maxShown) {
+        lines.append(QString("... и еще групп: %1").arg(clusters.size() - maxShown));
+    }
+    QMessageBox::information(this, "Похожие задачи",
+                             QString("Найдено групп: %1\n\n%2").arg(clusters.size()).arg(lines.join("\n")));
+}
+
 void MainWindow::showUserManagerDialog()
 {
     UserManagerDialog *dialog = new UserManagerDialog(m_taskService, this);
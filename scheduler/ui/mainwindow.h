@@ -45,6 +45,7 @@ private slots:
     void onSortChanged();
     void onUserManager();
     void onProjectManager();
+    void onFindDuplicates();
     void onImportTasks();
     void onExportTasks();
     void onUndo();
@@ -111,7 +111,7 @@ void ProjectManagerDialog::onEditProject()
     }
     
     QString desc = m_descriptionEdit->text().trimmed();
-    m_currentProject->setName(name);
+    m_taskService->renameProject(m_currentProject, name);
     m_currentProject->setDescription(desc);
     
     refreshProjectList();
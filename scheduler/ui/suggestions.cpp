@@ -0,0 +1,22 @@
+#include "suggestions.h"
+#include <QLineEdit>
+#include <QCompleter>
+#include <QStringListModel>
+
+void Suggestions::install(QLineEdit *edit, const std::function<QStringList(const QString &)> &source)
+{
+    if (!edit) {
+        return;
+    }
+    QStringListModel *model = new QStringListModel(edit);
+    QCompleter *completer = new QCompleter(model, edit);
+    completer->setCaseSensitivity(Qt::CaseInsensitive);
+    completer->setModelSorting(QCompleter::UnsortedModel);
+    completer->setCompletionMode(QCompleter::PopupCompletion);
+    edit->setCompleter(completer);
+    
+    // QLineEdit обновляет список после сигнала textEdited, поэтому модель уже свежая
+    QObject::connect(edit, &QLineEdit::textEdited, model, [model, source](const QString &text) {
+        model->setStringList(source(text));
+    });
+}
@@ -0,0 +1,18 @@
+#ifndef SUGGESTIONS_H
+#define SUGGESTIONS_H
+
+#include <QString>
+#include <QStringList>
+#include <functional>
+
+class QLineEdit;
+
+// Namespace для подсказок при вводе
+// Варианты не фильтруются QCompleter'ом заново - их порядок задает источник
+namespace Suggestions {
+    // Подключает к полю всплывающий список: при каждом изменении текста
+    // пользователем варианты запрашиваются у source (например, TaskService::completeTitle)
+    void install(QLineEdit *edit, const std::function<QStringList(const QString &)> &source);
+}
+
+#endif // SUGGESTIONS_H
@@ -4,6 +4,7 @@
 #include "../models/project.h"
 #include "../models/user.h"
 #include "appstyles.h"
+#include "suggestions.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QFormLayout>
@@ -92,7 +93,44 @@ void TaskEditorDialog::setupUI()
         for (User *user : m_taskService->getAllUsers()) {
             m_userCombo->addItem(user->getName(), user->getId());
         }
+        
+        // Подсказки по префиксу: повторяющиеся названия, владельцы и проекты
+        // набираются с клавиатуры, выбор в списке по-прежнему работает
+        TaskService *service = m_taskService;
+        Suggestions::install(m_titleEdit, [service](const QString &text) {
+            return service->completeTitle(text);
+        });
+        m_projectCombo->setEditable(true);
+        m_projectCombo->setInsertPolicy(QComboBox::NoInsert);
+        Suggestions::install(m_projectCombo->lineEdit(), [service](const QString &text) {
+            return service->completeProjectName(text);
+        });
+        m_userCombo->setEditable(true);
+        m_userCombo->setInsertPolicy(QComboBox::NoInsert);
+        Suggestions::install(m_userCombo->lineEdit(), [service](const QString &text) {
+            return service->completeUserName(text);
+        });
+    }
+}
+
+// Набранный в редактируемом списке текст - имя пользователя или проекта:
+// сначала точное совпадение с элементом списка, затем поиск по имени в сервисе
+int TaskEditorDialog::resolveComboIndex(QComboBox *combo, bool isUser) const
+{
+    QString text = combo->currentText().trimmed();
+    int index = combo->findText(text);
+    if (index >= 0 || !m_taskService) {
+        return index;
     }
+    int id = -1;
+    if (isUser) {
+        User *user = m_taskService->findUserByName(text);
+        id = user ? user->getId() : -1;
+    } else {
+        Project *project = m_taskService->findProjectByName(text);
+        id = project ? project->getId() : -1;
+    }
+    return id >= 0 ? combo->findData(id) : -1;
 }
 
 void TaskEditorDialog::setTask(Task *task)
@@ -138,10 +176,20 @@ void TaskEditorDialog::onAccept()
         return;
     }
     
-    if (m_userCombo->currentIndex() < 0) {
+    int userIndex = resolveComboIndex(m_userCombo, true);
+    if (userIndex < 0) {
         QMessageBox::warning(this, "Ошибка", "Выберите владельца задачи");
         return;
     }
+    m_userCombo->setCurrentIndex(userIndex);
+    
+    // Пустое поле проекта - задача без проекта
+    int projectIndex = m_projectCombo->currentText().trimmed().isEmpty() ? 0 : resolveComboIndex(m_projectCombo, false);
+    if (projectIndex < 0) {
+        QMessageBox::warning(this, "Ошибка", "Проект не найден");
+        return;
+    }
+    m_projectCombo->setCurrentIndex(projectIndex);
     
     Priority priority = static_cast<Priority>(m_priorityCombo->currentData().toInt());
     QDateTime deadline = m_deadlineEdit->dateTime();
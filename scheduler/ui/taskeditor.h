@@ -31,6 +31,7 @@ private:
     void setupUI();
     void loadTaskData();
     void applyStyles();
+    int resolveComboIndex(QComboBox *combo, bool isUser) const;
     
     TaskService *m_taskService;
     Task *m_task;
@@ -3,6 +3,7 @@
 #include "../models/project.h"
 #include "../models/user.h"
 #include "../data/taskservice.h"
+#include "../data/taskview.h"
 #include "../managers/command.h"
 #include "../managers/remindermanager.h"
 #include "taskeditor.h"
@@ -22,12 +23,14 @@
 #include <QDateEdit>
 #include <QCheckBox>
 #include <QTime>
+#include <QScrollBar>
 
 TaskListWidget::TaskListWidget(QWidget *parent)
     : QListWidget(parent),
       m_taskService(nullptr),
       m_commandManager(nullptr),
-      m_reminderManager(nullptr)
+      m_reminderManager(nullptr),
+      m_view(nullptr)
 {
 }
 
@@ -190,16 +193,74 @@ void TaskListWidget::updateTasks(const QList<Task*> &tasks)
     for (Task *task : tasks) {
         QListWidgetItem *item = new QListWidgetItem();
         addItem(item);
-        int itemWidth = qMax(width() - 20, 550);
-        formatTaskItem(task, item, itemWidth);
+        formatTaskItem(task, item, itemWidth());
     }
 }
 
+int TaskListWidget::itemWidth() const
+{
+    return qMax(width() - 20, 550);
+}
+
 void TaskListWidget::setDependencies(TaskService *service, CommandManager *commandManager, ReminderManager *reminderManager)
 {
     m_taskService = service;
     m_commandManager = commandManager;
     m_reminderManager = reminderManager;
+    
+    delete m_view;
+    m_view = new TaskView(service, this);
+    m_view->setPageSize(PAGE_SIZE);
+    connect(m_view, &TaskView::reset, this, &TaskListWidget::onViewReset);
+    connect(m_view, &TaskView::rowInserted, this, &TaskListWidget::onRowInserted);
+    connect(m_view, &TaskView::rowRemoved, this, &TaskListWidget::onRowRemoved);
+    connect(m_view, &TaskView::rowMoved, this, &TaskListWidget::onRowMoved);
+    connect(m_view, &TaskView::rowChanged, this, &TaskListWidget::onRowChanged);
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &TaskListWidget::onScrolled,
+            Qt::UniqueConnection);
+}
+
+void TaskListWidget::onScrolled(int value)
+{
+    // Подгружаем заранее, пока до конца списка остается меньше страницы
+    QScrollBar *bar = verticalScrollBar();
+    if (m_view && m_view->canFetchMore() && bar->maximum() - value < bar->pageStep() * 2) {
+        m_view->fetchMore();
+    }
+}
+
+void TaskListWidget::onViewReset()
+{
+    updateTasks(m_view->tasks());
+}
+
+void TaskListWidget::onRowInserted(int row)
+{
+    QListWidgetItem *item = new QListWidgetItem();
+    insertItem(row, item);
+    formatTaskItem(m_view->at(row), item, itemWidth());
+}
+
+void TaskListWidget::onRowRemoved(int row)
+{
+    delete takeItem(row);
+}
+
+void TaskListWidget::onRowMoved(int from, int to)
+{
+    // Выделение переносим вместе с элементом
+    bool wasCurrent = currentRow() == from;
+    QListWidgetItem *item = takeItem(from);
+    insertItem(to, item);
+    formatTaskItem(m_view->at(to), item, itemWidth());
+    if (wasCurrent) {
+        setCurrentItem(item);
+    }
+}
+
+void TaskListWidget::onRowChanged(int row)
+{
+    formatTaskItem(m_view->at(row), item(row), itemWidth());
 }
 
 void TaskListWidget::updateFilters(TaskService *service, QComboBox *projectFilter, QComboBox *userFilter)
@@ -357,7 +418,15 @@ void TaskListWidget::refreshTaskListWithFilters(QLineEdit *searchEdit, QComboBox
     
     // Формируем опции фильтрации из UI элементов
     TaskService::FilterOptions filterOpts;
-    filterOpts.searchText = searchEdit->text().trimmed();
+    // Строка поиска - текстовый запрос; обычный текст ищется в названии, как раньше.
+    // Строка, которая не разбирается как запрос (недописанное поле, текст с ':', '<',
+    // '!' или '-'), тоже ищется как подстрока названия - список не пустеет на ходу
+    QString searchText = searchEdit->text().trimmed();
+    if (m_taskService->queryError(searchText).isEmpty()) {
+        filterOpts.query = searchText;
+    } else {
+        filterOpts.searchText = searchText;
+    }
     
     int priorityFilterValue = priorityFilter->currentData().toInt();
     if (priorityFilterValue >= 0) {
@@ -388,11 +457,13 @@ void TaskListWidget::refreshTaskListWithFilters(QLineEdit *searchEdit, QComboBox
         sortCombo->currentData().toInt());
     sortOpts.ascending = true;
     
-    // Получаем отфильтрованные и отсортированные задачи из TaskService
-    QList<Task*> tasks = m_taskService->getFilteredAndSortedTasks(filterOpts, sortOpts);
-    
-    // Отображаем задачи
-    updateTasks(tasks);
+    // Представление перестраивается только при смене фильтров или сортировки,
+    // изменения самих задач оно применяет построчно по сигналам TaskService
+    if (m_view) {
+        m_view->setQuery(filterOpts, sortOpts);
+    } else {
+        updateTasks(m_taskService->getFilteredAndSortedTasks(filterOpts, sortOpts));
+    }
     
     // Не эмитируем taskListChanged здесь, чтобы избежать бесконечного цикла
     // Этот метод вызывается из updateTaskList, который уже вызывается из refreshTaskList
@@ -15,6 +15,7 @@ class QCheckBox;
 class CommandManager;
 class ReminderManager;
 class TaskEditorDialog;
+class TaskView;
 
 class TaskListWidget : public QListWidget
 {
@@ -55,6 +56,16 @@ signals:
     void taskListChanged();
     void taskDoubleClicked();
 
+private slots:
+    // Построчное обновление по уведомлениям TaskView
+    void onViewReset();
+    void onRowInserted(int row);
+    void onRowRemoved(int row);
+    void onRowMoved(int from, int to);
+    void onRowChanged(int row);
+    // Догрузка следующей страницы при прокрутке к концу списка
+    void onScrolled(int value);
+
 protected:
     void mousePressEvent(QMouseEvent *event) override;
     void mouseDoubleClickEvent(QMouseEvent *event) override;
@@ -63,6 +74,13 @@ private:
     TaskService *m_taskService;
     CommandManager *m_commandManager;
     ReminderManager *m_reminderManager;
+    // Живое представление: список обновляется по изменениям задач без полного пересчета
+    TaskView *m_view;
+    
+    int itemWidth() const;
+    
+    // Строк в странице живого представления (на экране помещается около 15)
+    static const int PAGE_SIZE = 100;
 };
 
 class TaskListDelegate : public QStyledItemDelegate
@@ -108,7 +108,7 @@ void UserManagerDialog::onEditUser()
         return;
     }
     
-    m_currentUser->setName(name);
+    m_taskService->renameUser(m_currentUser, name);
     
     refreshUserList();
     m_nameEdit->clear();